@@ -20,6 +20,14 @@
  
 #include <QStringList>
 #include <QMap>
+#include <QVector>
+#include <QDataStream>
+
+struct BehaviourMethod {
+    QString name;
+    QString description;
+    QString example;
+};
 
 class Behaviour {
 
@@ -34,16 +42,21 @@ public:
     void addControlMethod( QString controlType );
     QStringList getControlMethods();
 
-    void addMethod(QString methodName, QMap<QString, QString> methodHash );
-    QMap<QString, QString> getMethod( QString methodName );
-
-    QStringList getMethodsList();
+    // methods are kept sorted by name, method with already existing name is ignored
+    void addMethod( const BehaviourMethod &method );
+    const QVector<BehaviourMethod> &getMethods() const { return methods; }
 
 private:
 
     QStringList sutTypes;
     QStringList controlMethods;
-    QMap<QString, QMap<QString, QString> > methods;
+    QVector<BehaviourMethod> methods;
 
+    friend QDataStream &operator<<(QDataStream &out, const Behaviour &behaviour);
+    friend QDataStream &operator>>(QDataStream &in, Behaviour &behaviour);
 };
 
+QDataStream &operator<<(QDataStream &out, const BehaviourMethod &method);
+QDataStream &operator>>(QDataStream &in, BehaviourMethod &method);
+QDataStream &operator<<(QDataStream &out, const Behaviour &behaviour);
+QDataStream &operator>>(QDataStream &in, Behaviour &behaviour);
@@ -56,10 +56,16 @@ public:
     void drawHighlights( RectList geometries, bool multiple );
     void disableDrawHighlight();
 
+    // changed areas of image, and outlines of changed objects, in image coordinates
+    void drawDiff( const RectList &regions, const RectList &objects );
+    void clearDiff();
+    bool hasDiff() const { return !diffRegions.isEmpty() || !diffObjects.isEmpty(); }
+
     int imageWidth() { return image->width(); }
     int imageHeight() { return image->height(); }
     QString tasIdString() { return imageTasId; }
     QString lastImageFileName() const { return imageFileName; }
+    const QImage &currentImage() const { return *image; }
 
     QPoint getPosInImage(const QPoint &pos) {
         return QPoint(float(pos.x()) / zoomFactor, float(pos.y()) / zoomFactor);
@@ -142,6 +148,8 @@ private:
     float zoomFactor;
 
     RectList rects;
+    RectList diffRegions;
+    RectList diffObjects;
 
     MainWindow *objTreeOwner;
 };
@@ -2,14 +2,57 @@
 #define TDRIVER_MAIN_TYPES_H
 
 #include <QString>
+#include <QVector>
+#include <QBitArray>
+#include <QTreeWidgetItem>
 
-class QTreeWidgetItem;
 template <class T> class QList;
 class QRect;
 
 // types meant to be used in other code
 
-typedef void* TestObjectKey;
+// Test objects are numbered densely from 1 in tree build order, 0 means no object.
+// Key of an object tree item is stored in its column 0 with TestObjectKeyRole.
+typedef quint32 TestObjectKey;
+
+enum { TestObjectKeyRole = Qt::UserRole };
+
+
+// Per-object data in an array indexed directly by TestObjectKey, with the
+// interface of the QMaps it replaces. value() returns a reference, which stays
+// valid until a new key is added.
+template <typename T>
+class TestObjectArray
+{
+public:
+    bool contains(TestObjectKey key) const {
+        return key < TestObjectKey(present.size()) && present.testBit(key);
+    }
+
+    const T &value(TestObjectKey key) const {
+        return contains(key) ? items.at(key) : defaultValue();
+    }
+
+    T &operator[](TestObjectKey key) {
+        if (key >= TestObjectKey(items.size())) {
+            int size = qMax(int(key) + 1, items.size() * 2);
+            items.resize(size);
+            present.resize(size);
+        }
+        present.setBit(key);
+        return items[key];
+    }
+
+    void insert(TestObjectKey key, const T &value) { (*this)[key] = value; }
+    void clear() { items.clear(); present.clear(); }
+    void swap(TestObjectArray &other) { items.swap(other.items); present.swap(other.present); }
+
+private:
+    static const T &defaultValue() { static const T instance = T(); return instance; }
+
+    QVector<T> items;
+    QBitArray present;
+};
 
 
 typedef QList<QRect> RectList;
@@ -54,29 +97,18 @@ struct ApplicationInfo {
 //};
 
 
-// internal convenience type, not really intended to be used outside this header
-
-typedef QTreeWidgetItem *TestObjectPtrType;
-
-
-
-// convenience functions meant to hide static casts
-
-static inline TestObjectPtrType testObjectKey2Ptr(TestObjectKey key) {
-    return static_cast<TestObjectPtrType>(key);
-}
+// convenience functions meant to hide item data access
 
-static inline TestObjectKey ptr2TestObjectKey(TestObjectPtrType ptr) {
-    return static_cast<TestObjectKey>(ptr);
+static inline TestObjectKey ptr2TestObjectKey(const QTreeWidgetItem *ptr) {
+    return ptr ? ptr->data(0, TestObjectKeyRole).toUInt() : 0;
 }
 
 static inline QString testObjectKey2Str(TestObjectKey key) {
-    return QString::number((quintptr)(key));
+    return QString::number(key);
 }
 
 static inline TestObjectKey str2TestObjectKey(const QString &str) {
-    return ptr2TestObjectKey(reinterpret_cast<TestObjectPtrType >(
-                                 static_cast<quintptr>(str.toULongLong())));
+    return str.toUInt();
 }
 
 #endif // TDRIVER_MAIN_TYPES_H
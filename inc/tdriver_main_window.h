@@ -50,6 +50,7 @@
 #include <QPushButton>
 #include <QStackedLayout>
 #include <QStatusBar>
+#include <QTableView>
 #include <QTableWidget>
 #include <QTabWidget>
 #include <QTreeWidget>
@@ -60,6 +61,8 @@
 #include <QDomElement>
 #include <QDomNode>
 #include <QXmlStreamReader>
+#include <QSharedPointer>
+#include <QVector>
 
 class QErrorMessage;
 class QScrollArea;
@@ -72,6 +75,10 @@ class QPlainTextEdit;
 // visualizer UI classes
 class TDriverRecorder;
 class TDriverImageView;
+class TDriverObjectIndex;
+class TDriverLocatorAnalyzer;
+class TDriverFindAllPanel;
+class TDriverAttributesModel;
 
 // libeditor classes
 class TDriverTabbedEditor;
@@ -118,9 +125,12 @@ public:
         commandBehavioursXml,
         commandGetVersionNumber,
         commandSignalList,
+        commandPrefetchSignalList,
         commandGetDeviceParameter,
         commandGetAllDeviceParameters,
         commandStartApplication,
+        commandBatch,
+        commandWatchUi,
         commandInvalid
     };
 
@@ -151,6 +161,29 @@ private:
         {}
     };
 
+    // snapshot state of a device that is not currently shown
+    struct DeviceSession {
+        QList<QTreeWidgetItem*> treeItems;
+        QVector<QTreeWidgetItem*> objectItems;
+        TestObjectKey currentItem;
+        TestObjectArray<QMap<QString, AttributeInfo > > attributes;
+        TestObjectArray<RectList> geometries;
+        QSet<TestObjectKey> screenshotObjects;
+        TestObjectArray<TreeItemInfo> treeData;
+        QHash<QString, TestObjectKey> idMap;
+        QSharedPointer<TDriverObjectIndex> objectIndex;
+        QSharedPointer<TDriverLocatorAnalyzer> locatorAnalyzer;
+        QMap<QString, QString> applicationsNames;
+        ApplicationInfo currentApplication;
+        QString uiDumpFileName;
+        QString imageFileName;
+        QString watchDigest;
+        QList<QStringList> batchOperations;
+        QStringList batchDescriptions;
+
+        DeviceSession() : currentItem(0) {}
+    };
+
     struct SavedLayout {
         QString name;
         QByteArray state;
@@ -191,10 +224,10 @@ public:
     bool isPathAction(ContextMenuSelection action) { return (action == copyPathAction || action == appendPathAction || action == insertPathAction); }
 
 public:    // methods to access test object data by object id
-    const QMap<QString, AttributeInfo > &testobjAttributes(TestObjectKey id) { return attributesMap[id]; }
+    const QMap<QString, AttributeInfo > &testobjAttributes(TestObjectKey id) { return attributesMap.value(id); }
     //const QStringList &testobjGeometries(AttributeKey id) { return geometriesMap[id]; }
     //const QTreeWidgetItem *testobjTreeWidget(AttributeKey id) { return objectTreeMap[id]; }
-    const TreeItemInfo &testobjTreeData(TestObjectKey id) { return objectTreeData[id]; }
+    const TreeItemInfo &testobjTreeData(TestObjectKey id) { return objectTreeData.value(id); }
 
 public slots:
     void refreshScreenshotObjectList();
@@ -220,6 +253,11 @@ private:
                             const QString &errorName,
                             const QString &typeStr = QString());
 
+    bool sendTDriverCommand(ExecuteCommandType commandType,
+                            const BAListMap &msg,
+                            const QString &errorName,
+                            const QString &typeStr = QString());
+
     bool resendTDriverCommand(SentTDriverMsg &msg);
 
     bool executeTDriverCommand(ExecuteCommandType commandType,
@@ -255,16 +293,21 @@ private:
     QMap<QString, QString> applicationsNamesMap;
     QMap<QAction*, QString> applicationsActionMap;
 
-    QMap<TestObjectKey, QMap<QString, AttributeInfo > > attributesMap;
+    TestObjectArray<QMap<QString, AttributeInfo > > attributesMap;
     QHash<QString, QMap<QString, QHash<QString, QString> > > apiMethodsMap;
     QHash<QString, QStringList > apiSignalsMap;
     QMap<QString, Behaviour> behavioursMap;
 
-    QMap<TestObjectKey, RectList> geometriesMap;
+    TestObjectArray<RectList> geometriesMap;
     QSet<TestObjectKey> screenshotObjects;
 
-    QMap<TestObjectKey, TreeItemInfo > objectTreeData;
+    TestObjectArray<TreeItemInfo> objectTreeData;
     QHash<QString, TestObjectKey> objectIdMap;
+
+    // object tree items by TestObjectKey, index 0 is unused
+    QVector<QTreeWidgetItem*> objectItems;
+    QTreeWidgetItem *objectItem(TestObjectKey key) const { return (key < TestObjectKey(objectItems.size())) ? objectItems.at(key) : 0; }
+    TestObjectKey registerObjectItem(QTreeWidgetItem *item);
     //    QHash<QString, QMap<QString, QString> > objectMethods;
     //    QHash<QString, QMap<QString, QString> > objectSignals;
 
@@ -299,7 +342,8 @@ private:
     void createPropertiesDockWidgetApiTabWidget();
 
 
-    QTableWidget *propertiesTable;
+    QTableView *propertiesTable;
+    TDriverAttributesModel *propertiesModel;
     QTableWidget *methodsTable;
     QTableWidget *signalsTable;
 
@@ -323,6 +367,7 @@ private:
     void updateAttributesTableContent();
     void updateMethodsTableContent();
     bool sendUpdateSignalsTableContent();
+    void fillSignalsTable( const QStringList &signalsList );
     void sendUpdateApiTableContent();
 
     // object tree
@@ -351,17 +396,15 @@ private:
     bool parseObjectTreeXml( QString filename, QDomDocument &resultDomTree );
     void buildScreenshotObjectList(TestObjectKey parentKey=0);
 
-    void buildObjectTree( QTreeWidgetItem *parentItem, QDomElement parentElement, QMap<QString, QStringList> duplicateItems );
-    void buildObjectTree_new_format( QTreeWidgetItem *parentItem, QDomElement parentElement, QMap<QString, QStringList> duplicateItems );
-
-    QList<QMap<QString, QString> > collectObjectData( QDomElement element );
-    QList<QMap<QString, QString> > collectObjectData_new_format( QDomElement element );
+    void buildObjectTree( QTreeWidgetItem *parentItem, QDomElement parentElement );
+    void buildObjectTree_new_format( QTreeWidgetItem *parentItem, QDomElement parentElement );
 
-    QMap<QString, QStringList> findDuplicateObjectNames( QList<QMap<QString, QString> > objects );
+    void markDuplicateObjectNames();
+    QString objectTreeToolTip(QTreeWidgetItem *item, int column);
 
     void storeItemToObjectTreeMap( QTreeWidgetItem *item, const TreeItemInfo &data);
 
-    QTreeWidgetItem * createObjectTreeItem( QTreeWidgetItem *parentItem, const TreeItemInfo &data, QMap<QString, QStringList> duplicateItems );
+    QTreeWidgetItem * createObjectTreeItem( QTreeWidgetItem *parentItem, const TreeItemInfo &data );
 
     void objectTreeItemChanged();
 
@@ -378,6 +421,7 @@ private:
     QDockWidget *runDock;
     QDockWidget *debugDock;
     QDockWidget *irDock;
+    QDockWidget *fileSearchDock;
     void createEditorDocks();
     void setEditorDocksDefaultLayout();
     TDriverTabbedEditor *tabEditor;
@@ -398,9 +442,6 @@ private:
     // ui dump xml
     QDomDocument xmlDocument;
 
-    // behaviours xml
-    QDomDocument behaviorDomDocument;
-
     // tdriver_parameters.xml
     bool getXmlParameters( QString filename );
     void updateDevicesList(const QStringList &newDeviceList);
@@ -411,9 +452,26 @@ private:
     void resetApplicationsList();
 
     // behaviours.xml
-    void buildBehavioursMap();
+    bool buildBehavioursMap( const QString &fileName );
     bool sendUpdateBehaviourXml();
 
+    // on-disk cache of behaviours, signals and api methods
+    void syncMetadataCache();
+    void resetMetadataCache();
+    void saveMetadataCache();
+    QString metadataCacheFile;
+    bool metadataCacheDirty;
+
+    // low priority signal list requests for object types near selection
+    enum { SIGNAL_PREFETCH_IN_FLIGHT_LIMIT = 2 };
+    void scheduleSignalPrefetch();
+    bool isSignalPrefetchCandidate( TestObjectKey key ) const;
+    bool hasPendingForegroundCommands() const;
+    void signalPrefetchReceived( const QString &objectType, const QString &fileName );
+    QList<TestObjectKey> signalPrefetchQueue;
+    QSet<QString> signalPrefetchInFlight;
+    QSet<QString> signalPrefetchFailed;
+
     // visualizer_dump_sut_id.xml
     void parseUiDump( QString filename );
 
@@ -475,6 +533,9 @@ private:
     QAction *appsRefreshAction;
     QAction *refreshAction;
     QAction *delayedRefreshAction;
+    QAction *batchModeAction;
+    QAction *batchSendAction;
+    QAction *watchModeAction;
     QAction *sutDisconnectAction;
     QAction *exitAction;
 
@@ -483,6 +544,7 @@ private:
     QAction *showXmlAction;
     // search
     QAction *findAction;
+    QAction *findAllAction;
 
     enum { SAVEDLAYOUTCOUNT = 3 };
     SavedLayout savedLayouts[SAVEDLAYOUTCOUNT];
@@ -507,6 +569,27 @@ private:
 
     void sendTapScreen(const QStringList &target);
 
+    // batch mode: operations are queued and sent in one message, followed by one refresh
+    bool queueBatchOperation(const QStringList &operation, const QString &description);
+    void discardBatch();
+    void updateBatchActions();
+    void handleBatchReply(const BAListMap &reply);
+    QList<QStringList> batchOperations;
+    QStringList batchDescriptions;
+    QStringList batchSentDescriptions;
+
+    // per device snapshots, so switching between devices needs no refetch
+    void storeDeviceSession(const QString &device);
+    bool restoreDeviceSession(const QString &device);
+    bool isReplyForOtherDevice(const SentTDriverMsg &sentMsg) const;
+    QHash<QString, DeviceSession> deviceSessions;
+
+    // watch mode: polls UI digest, backing off while nothing changes
+    enum { WATCH_INTERVAL_MIN = 500, WATCH_INTERVAL_MAX = 8000 };
+    void handleWatchReply(const BAListMap &reply);
+    int watchInterval;
+    QString watchDigest;
+
     void createImageViewDockWidget();
 
     // highlight
@@ -588,8 +671,21 @@ private:
     QPushButton *findDialogCloseButton;
     QTreeWidgetItem *findDialogSubtreeRoot;
 
-    bool containsWords( const TreeItemInfo &itemData, QString text, bool caseSensitive, bool entireWords  );
-    bool attributeContainsWords( TestObjectKey itemPtr, QString text, bool caseSensitive, bool entireWords );
+    // search index of current object tree, replaced (not modified) when tree changes
+    QSharedPointer<TDriverObjectIndex> objectIndex;
+    QSharedPointer<TDriverLocatorAnalyzer> locatorAnalyzer;
+    void rebuildObjectIndex();
+
+    // object query
+    QLineEdit *objectQueryEdit;
+    QVector<int> objectQueryResults;
+    int objectQueryPosition;
+    QString objectQueryLastText;
+
+    // find all
+    void createFindAllDockWidget();
+    QDockWidget *findAllDock;
+    TDriverFindAllPanel *findAllPanel;
 
     QErrorMessage *tdriverMsgBox;
     int tdriverMsgTotal;
@@ -633,7 +729,7 @@ private slots:
     void tabWidgetChanged( int currentTableWidget );
 
     void methodItemPressed( QTableWidgetItem *item );
-    void propertiesItemPressed( QTableWidgetItem *item );
+    void propertiesItemPressed( const QModelIndex &index );
     void apiItemPressed( QTableWidgetItem *item );
 
     void showMainVisualizerAssistant();
@@ -653,7 +749,7 @@ private slots:
     void createClipboardBar();
 
     void updateClipboardText( QString text, bool appendText );
-    void changePropertiesTableValue( QTableWidgetItem *item );
+    void changePropertiesTableValue( const QString &attributeName, const QString &value );
 
 
     // object tree
@@ -685,6 +781,10 @@ private slots:
     void saveStateAsArchive();
     void clickedImage();
 
+    // image view: compare with state history
+    void compareImageWithHistoryDir(const QString &dirPath);
+    void clearImageDiff();
+
     void openFontDialog();
     bool disconnectSUT();
     bool disconnectExclusiveSUT();
@@ -747,6 +847,11 @@ private slots:
     void findDialogTextChanged( const QString & text );
     void findDialogHandleTreeCurrentChange(QTreeWidgetItem*current);
     void findDialogSubtreeChanged( int value);
+
+    void showFindAll();
+    void findAllObjectActivated(TestObjectKey key);
+
+    void runObjectQuery();
     void closeFindDialog();
 
     // start app dialog slots
@@ -759,11 +864,18 @@ private slots:
     void receiveTDriverMessage(quint32 seqNum, QByteArray name, const BAListMap &reply = BAListMap());
     void messageTimeoutSlot();
     void resetMessageSequenceFlags();
+    void sendSignalPrefetch();
+    void toggleBatchMode(bool enabled);
+    void sendBatch();
+    void toggleWatchMode(bool enabled);
+    void sendWatchPoll();
 
 private:
 
     QMap<quint32, SentTDriverMsg> sentTDriverMsgs; // maps seqnum of sent message to message type
     QTimer *messageTimeoutTimer;
+    QTimer *signalPrefetchTimer;
+    QTimer *watchTimer;
     bool doRefreshAfterAppList;
     int historySavingCounter; // -1 for done state; bits to reset: 1 for dui dump, 2 for image
     QWidget *richTextContainerWidget;
@@ -776,9 +888,8 @@ private:
     void closeEvent( QCloseEvent *event );
 
     QString treeObjectRubyId(TestObjectKey treeItemPtr, TestObjectKey sutItemPtr);
+    QString treeObjectLocator(TestObjectKey treeItemPtr, TestObjectKey sutItemPtr);
     QTreeWidgetItem *findDialogSubtreeNext(QTreeWidgetItem *current, QTreeWidgetItem *root, bool wrap=false);
-    QTreeWidgetItem *findDialogSubtreePrev(QTreeWidgetItem *current, QTreeWidgetItem *root, bool wrap=false);
-    bool compareTreeItem(QTreeWidgetItem *item, const QString &findString, bool matchCase, bool entireWords, bool searchAttributes);
     void findFromSubTree(QTreeWidgetItem *current, const QString &findString, bool backwards, bool matchCase, bool entireWords, bool searchWrapAround, bool searchAttributes);
 
 };
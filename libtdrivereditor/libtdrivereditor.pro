@@ -23,7 +23,7 @@ include (../visualizer.pri)
 
 TARGET = tdrivereditor
 
-QT += network widgets
+QT += network widgets concurrent
 
 TEMPLATE = lib
 CONFIG += shared
@@ -47,7 +47,12 @@ SOURCES += tdriver_tabbededitor.cpp \
     tdriver_editor_common.cpp \
     tdriver_rubyinteract.cpp \
     tdriver_editbar.cpp \
-    tdriver_combolineedit.cpp
+    tdriver_combolineedit.cpp \
+    tdriver_blockstructure.cpp \
+    tdriver_filesearchpanel.cpp \
+    tdriver_symbolindex.cpp \
+    tdriver_completioncache.cpp \
+    tdriver_largefileview.cpp
 HEADERS += tdriver_tabbededitor.h \
     tdriver_runconsole.h \
     tdriver_rubyhighlighter.h \
@@ -59,6 +64,11 @@ HEADERS += tdriver_tabbededitor.h \
     tdriver_rubyinteract.h \
     tdriver_editbar.h \
     tdriver_combolineedit.h \
+    tdriver_blockstructure.h \
+    tdriver_filesearchpanel.h \
+    tdriver_symbolindex.h \
+    tdriver_completioncache.h \
+    tdriver_largefileview.h \
     libtdrivereditor_global.h
 
 # install
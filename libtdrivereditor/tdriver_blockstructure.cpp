@@ -0,0 +1,401 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#include "tdriver_blockstructure.h"
+
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QString>
+
+
+static inline bool isWordChar(QChar ch)
+{
+    return ch.isLetterOrNumber() || ch == '_';
+}
+
+
+static inline bool isPair(char opener, char closer)
+{
+    return (opener == '(' && closer == ')')
+            || (opener == '[' && closer == ']')
+            || (opener == '{' && closer == '}')
+            || (opener == 'o' && closer == 'e');
+}
+
+
+TDriverBlockStructure::TDriverBlockStructure(QTextDocument *doc, QObject *parent) :
+    QObject(parent),
+    doc(doc),
+    isRubyMode(false),
+    validDepthCount(0)
+{
+    Q_ASSERT(doc);
+    connect(doc, SIGNAL(contentsChange(int,int,int)), this, SLOT(contentsChange(int,int,int)));
+    rebuild();
+}
+
+
+void TDriverBlockStructure::setRubyMode(bool enabled)
+{
+    if (enabled != isRubyMode) {
+        isRubyMode = enabled;
+        rebuild();
+    }
+}
+
+
+int TDriverBlockStructure::blockDepth(int blockNumber)
+{
+    if (blockNumber < 0 || blockNumber >= blocks.size()) return 0;
+    ensureDepth(blockNumber);
+    return blocks.at(blockNumber).depth;
+}
+
+
+int TDriverBlockStructure::blockOpenCount(int blockNumber) const
+{
+    if (blockNumber < 0 || blockNumber >= blocks.size()) return 0;
+    const BlockInfo &info = blocks.at(blockNumber);
+    return info.delta - info.minRel;
+}
+
+
+int TDriverBlockStructure::foldEnd(int blockNumber)
+{
+    if (blockOpenCount(blockNumber) <= 0) return -1;
+    ensureDepth(blockNumber);
+
+    // outermost construct left open on the block is closed when depth drops back to its level
+    int depth = blocks.at(blockNumber).depth + blocks.at(blockNumber).minRel;
+    int foundBlock, foundToken;
+    if (findClosing(blockNumber, blocks.at(blockNumber).tokens.size() - 1, depth, foundBlock, foundToken)) {
+        return foundBlock;
+    }
+    return -1;
+}
+
+
+TDriverBlockStructure::PairResult TDriverBlockStructure::findPair(QTextCursor &cursor)
+{
+    int position = cursor.hasSelection() ? cursor.selectionStart() : cursor.position();
+    QTextBlock block = doc->findBlock(position);
+    if (!block.isValid() || block.blockNumber() >= blocks.size()) return NoDelimiter;
+
+    const int num = block.blockNumber();
+    const int rel = position - block.position();
+    const QVector<Token> &tokens = blocks.at(num).tokens;
+
+    int index = -1;
+    for (int ii = 0; ii < tokens.size(); ++ii) {
+        if (tokens.at(ii).pos <= rel && rel < tokens.at(ii).pos + tokens.at(ii).length) {
+            index = ii;
+            break;
+        }
+    }
+    if (index < 0) return NoDelimiter;
+
+    ensureDepth(num);
+    int depth = blocks.at(num).depth;
+    for (int ii = 0; ii < index; ++ii) {
+        depth += tokens.at(ii).isOpener() ? 1 : -1;
+    }
+
+    const Token token = tokens.at(index);
+    int foundBlock, foundToken;
+    bool found = (token.isOpener())
+            ? findClosing(num, index, depth, foundBlock, foundToken)
+            : findOpening(num, index, depth - 1, foundBlock, foundToken);
+    if (!found) return Unmatched;
+
+    const Token pair = blocks.at(foundBlock).tokens.at(foundToken);
+    if (token.isOpener() ? !isPair(token.ch, pair.ch) : !isPair(pair.ch, token.ch)) return Unmatched;
+
+    int pairPos = doc->findBlockByNumber(foundBlock).position() + pair.pos;
+    cursor.setPosition(pairPos);
+    cursor.setPosition(pairPos + pair.length, QTextCursor::KeepAnchor);
+    return Matched;
+}
+
+
+void TDriverBlockStructure::contentsChange(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved);
+
+    const int count = doc->blockCount();
+    const int diff = count - blocks.size();
+
+    QTextBlock first = doc->findBlock(position);
+    QTextBlock last = doc->findBlock(position + charsAdded);
+    int firstNum = (first.isValid()) ? first.blockNumber() : count - 1;
+    int lastNum = (last.isValid()) ? last.blockNumber() : count - 1;
+
+    // old blocks firstNum..lastNum-diff were replaced by new blocks firstNum..lastNum
+    if (blocks.isEmpty() || firstNum >= blocks.size() || lastNum - diff < firstNum) {
+        rebuild();
+        return;
+    }
+
+    if (diff > 0) {
+        blocks.insert(firstNum, diff, BlockInfo());
+    }
+    else if (diff < 0) {
+        blocks.remove(firstNum, -diff);
+    }
+    if (diff != 0) validDepthCount = qMin(validDepthCount, firstNum + 1);
+
+    rescan(firstNum, lastNum);
+}
+
+
+void TDriverBlockStructure::rebuild()
+{
+    blocks.clear();
+    blocks.resize(doc->blockCount());
+    validDepthCount = 0;
+
+    int state = CodeState;
+    int num = 0;
+    for (QTextBlock block = doc->begin(); block.isValid() && num < blocks.size(); block = block.next(), ++num) {
+        scanBlock(block.text(), state, blocks[num]);
+        state = blocks.at(num).endState;
+    }
+}
+
+
+void TDriverBlockStructure::addToken(BlockInfo &info, int pos, int length, char ch)
+{
+    Token token = { pos, short(length), ch };
+    info.tokens.append(token);
+    info.delta += token.isOpener() ? 1 : -1;
+    if (info.delta < info.minRel) info.minRel = info.delta;
+}
+
+
+void TDriverBlockStructure::scanBlock(const QString &text, int startState, BlockInfo &info) const
+{
+    info.tokens.clear();
+    info.delta = 0;
+    info.minRel = 0;
+    info.endState = CodeState;
+    const int len = text.size();
+
+    if (!isRubyMode) {
+        // plain text, every bracket counts
+        for (int ii = 0; ii < len; ++ii) {
+            char ch = text.at(ii).toLatin1();
+            if (ch == '(' || ch == '[' || ch == '{' || ch == ')' || ch == ']' || ch == '}') {
+                addToken(info, ii, 1, ch);
+            }
+        }
+        return;
+    }
+
+    if (startState == BlockCommentState) {
+        if (!text.startsWith("=end")) info.endState = BlockCommentState;
+        return;
+    }
+    if (text.startsWith("=begin")) {
+        info.endState = BlockCommentState;
+        return;
+    }
+
+    int state = (startState == InvalidState) ? CodeState : startState;
+    bool statementStart = true;
+    bool loopDoPending = false; // optional "do" after while/until/for condition does not open a block
+    int ii = 0;
+
+    while (ii < len) {
+        if (state != CodeState) {
+            QChar quote((state == DoubleQuoteState) ? '"' : (state == SingleQuoteState) ? '\'' : '`');
+            while (ii < len && text.at(ii) != quote) {
+                if (text.at(ii) == '\\') ++ii;
+                ++ii;
+            }
+            if (ii < len) {
+                state = CodeState;
+                ++ii;
+            }
+            continue;
+        }
+
+        const QChar qch = text.at(ii);
+        const char ch = qch.toLatin1();
+
+        if (qch.isSpace()) {
+            ++ii;
+        }
+        else if (ch == '#') {
+            break;
+        }
+        else if (ch == '"' || ch == '\'' || ch == '`') {
+            state = (ch == '"') ? DoubleQuoteState : (ch == '\'') ? SingleQuoteState : BacktickState;
+            statementStart = false;
+            ++ii;
+        }
+        else if (ch == '(' || ch == '[' || ch == '{') {
+            addToken(info, ii, 1, ch);
+            statementStart = true;
+            ++ii;
+        }
+        else if (ch == ')' || ch == ']' || ch == '}') {
+            addToken(info, ii, 1, ch);
+            statementStart = false;
+            ++ii;
+        }
+        else if (qch.isLetter() || ch == '_') {
+            int start = ii;
+            while (ii < len && isWordChar(text.at(ii))) ++ii;
+
+            QChar prev = (start > 0) ? text.at(start-1) : QChar(' ');
+            bool suffixed = (ii < len && (text.at(ii) == '?' || text.at(ii) == '!'));
+            bool label = (ii < len && text.at(ii) == ':' && (ii+1 >= len || text.at(ii+1) != ':'));
+
+            if (suffixed) {
+                ++ii;
+            }
+            else if (prev != '.' && prev != ':' && prev != '@' && prev != '$' && !label) {
+                QStringRef word = text.midRef(start, ii - start);
+                if (word == "end") {
+                    addToken(info, start, 3, 'e');
+                }
+                else if (word == "def" || word == "class" || word == "module" || word == "begin" || word == "case") {
+                    addToken(info, start, word.size(), 'o');
+                }
+                else if (word == "do") {
+                    if (loopDoPending) loopDoPending = false;
+                    else addToken(info, start, 2, 'o');
+                }
+                else if (statementStart && (word == "if" || word == "unless")) {
+                    addToken(info, start, word.size(), 'o');
+                }
+                else if (statementStart && (word == "while" || word == "until" || word == "for")) {
+                    addToken(info, start, word.size(), 'o');
+                    loopDoPending = true;
+                }
+                // "return if x" is a modifier, so return does not start a statement for if/unless/while/until
+                statementStart = (word == "then" || word == "else" || word == "do" || word == "begin"
+                                  || word == "and" || word == "or" || word == "not");
+                continue;
+            }
+            statementStart = false;
+        }
+        else {
+            if (ch == ';') loopDoPending = false;
+            statementStart = (ch == ';' || ch == '=' || ch == ',' || ch == '|' || ch == '&' || ch == '!');
+            ++ii;
+        }
+    }
+
+    info.endState = state;
+}
+
+
+void TDriverBlockStructure::rescan(int first, int last)
+{
+    bool deltaChanged = false;
+    int num = first;
+
+    for (QTextBlock block = doc->findBlockByNumber(first); block.isValid() && num < blocks.size(); block = block.next(), ++num) {
+        BlockInfo &info = blocks[num];
+        const int oldEndState = info.endState;
+        const int oldDelta = info.delta;
+
+        scanBlock(block.text(), (num > 0) ? blocks.at(num-1).endState : int(CodeState), info);
+        if (info.delta != oldDelta) deltaChanged = true;
+
+        // continue past changed range only while string or comment state keeps changing
+        if (num >= last && info.endState == oldEndState) break;
+    }
+
+    if (deltaChanged) validDepthCount = qMin(validDepthCount, first + 1);
+}
+
+
+void TDriverBlockStructure::ensureDepth(int blockNumber)
+{
+    if (validDepthCount == 0 && !blocks.isEmpty()) {
+        blocks[0].depth = 0;
+        validDepthCount = 1;
+    }
+    while (validDepthCount <= blockNumber && validDepthCount < blocks.size()) {
+        const BlockInfo &prev = blocks.at(validDepthCount - 1);
+        blocks[validDepthCount].depth = prev.depth + prev.delta;
+        ++validDepthCount;
+    }
+}
+
+
+bool TDriverBlockStructure::findClosing(int blockNumber, int tokenIndex, int depth, int &foundBlock, int &foundToken)
+{
+    ensureDepth(blockNumber);
+
+    int running = blocks.at(blockNumber).depth;
+    for (int num = blockNumber; num < blocks.size(); ++num) {
+        if (num > blockNumber) {
+            ensureDepth(num);
+            // skip blocks where depth never drops to searched level
+            if (blocks.at(num).depth + blocks.at(num).minRel > depth) continue;
+            running = blocks.at(num).depth;
+        }
+
+        const QVector<Token> &tokens = blocks.at(num).tokens;
+        for (int ii = 0; ii < tokens.size(); ++ii) {
+            running += tokens.at(ii).isOpener() ? 1 : -1;
+            if (num == blockNumber && ii <= tokenIndex) continue;
+            if (!tokens.at(ii).isOpener() && running == depth) {
+                foundBlock = num;
+                foundToken = ii;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+bool TDriverBlockStructure::findOpening(int blockNumber, int tokenIndex, int depth, int &foundBlock, int &foundToken)
+{
+    ensureDepth(blockNumber);
+
+    QVector<int> preDepths;
+    for (int num = blockNumber; num >= 0; --num) {
+        const BlockInfo &info = blocks.at(num);
+        // skip blocks where depth never drops to searched level
+        if (num < blockNumber && info.depth + info.minRel > depth) continue;
+
+        int count = (num == blockNumber) ? tokenIndex : info.tokens.size();
+        preDepths.resize(count);
+        int running = info.depth;
+        for (int ii = 0; ii < count; ++ii) {
+            preDepths[ii] = running;
+            running += info.tokens.at(ii).isOpener() ? 1 : -1;
+        }
+        for (int ii = count - 1; ii >= 0; --ii) {
+            if (info.tokens.at(ii).isOpener() && preDepths.at(ii) == depth) {
+                foundBlock = num;
+                foundToken = ii;
+                return true;
+            }
+        }
+    }
+    return false;
+}
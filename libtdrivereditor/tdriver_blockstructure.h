@@ -0,0 +1,95 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#ifndef TDRIVER_BLOCKSTRUCTURE_H
+#define TDRIVER_BLOCKSTRUCTURE_H
+
+#include "libtdrivereditor_global.h"
+
+#include <QObject>
+#include <QVector>
+
+class QTextDocument;
+class QTextCursor;
+class QString;
+
+// Nesting structure of a document: brackets, and in Ruby mode also keyword
+// blocks (def/do/if ... end), with strings and comments skipped.
+// Kept up to date from QTextDocument::contentsChange, only changed blocks are rescanned.
+class LIBTDRIVEREDITORSHARED_EXPORT TDriverBlockStructure : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum PairResult { NoDelimiter, Unmatched, Matched };
+
+    explicit TDriverBlockStructure(QTextDocument *doc, QObject *parent = 0);
+
+    void setRubyMode(bool enabled);
+    bool rubyMode() const { return isRubyMode; }
+
+    // nesting depth at start of block
+    int blockDepth(int blockNumber);
+    // number of blocks opened but not closed on the block
+    int blockOpenCount(int blockNumber) const;
+    // last block of the construct opened on given block, or -1 if block opens nothing or it's not closed
+    int foldEnd(int blockNumber);
+
+    // cursor selection start must be at a delimiter, on Matched cursor will select the pair
+    PairResult findPair(QTextCursor &cursor);
+
+private slots:
+    void contentsChange(int position, int charsRemoved, int charsAdded);
+    void rebuild();
+
+private:
+    enum ScanState { CodeState = 0, DoubleQuoteState, SingleQuoteState, BacktickState, BlockCommentState, InvalidState };
+
+    struct Token {
+        int pos; // position in block
+        short length;
+        char ch; // bracket character, 'o' for keyword opener, 'e' for keyword closer
+        bool isOpener() const { return ch == '(' || ch == '[' || ch == '{' || ch == 'o'; }
+    };
+
+    struct BlockInfo {
+        BlockInfo() : depth(0), delta(0), minRel(0), endState(InvalidState) {}
+        int depth; // valid only below validDepthCount
+        int delta;
+        int minRel; // minimum depth inside block, relative to start
+        int endState;
+        QVector<Token> tokens;
+    };
+
+    static void addToken(BlockInfo &info, int pos, int length, char ch);
+    void scanBlock(const QString &text, int startState, BlockInfo &info) const;
+    void rescan(int first, int last);
+    void ensureDepth(int blockNumber);
+    bool findClosing(int blockNumber, int tokenIndex, int depth, int &foundBlock, int &foundToken);
+    bool findOpening(int blockNumber, int tokenIndex, int depth, int &foundBlock, int &foundToken);
+
+    QTextDocument *doc;
+    bool isRubyMode;
+    QVector<BlockInfo> blocks;
+    int validDepthCount;
+};
+
+#endif // TDRIVER_BLOCKSTRUCTURE_H
@@ -37,16 +37,21 @@
 #include <QStandardItem>
 #include <QStandardItemModel>
 #include <QModelIndex>
-#include <QFileSystemWatcher>
 #include <QPushButton>
+#include <QTimer>
+#include <QToolTip>
 
 #include <tdriver_util.h>
+#include <tdriver_filewatcher.h>
 
 #ifndef TDRIVER_NO_SQL
 #include <tdriver_translationdb.h>
 #endif
 
 #include "tdriver_editor_common.h"
+#include "tdriver_blockstructure.h"
+#include "tdriver_symbolindex.h"
+#include "tdriver_completioncache.h"
 #include <tdriver_debug_macros.h>
 
 #define ALWAYS_USE_RUBY_SYMBOLS 1
@@ -77,13 +82,15 @@ TDriverCodeTextEdit::TDriverCodeTextEdit(QWidget *parent) :
     noNameId(++noNameIdCounter),
     sideArea(new SideArea(this)),
     highlighter(NULL),
+    blockStructure(new TDriverBlockStructure(document(), this)),
+    symbolIndex(NULL),
+    completionCache(NULL),
     needSyntaxRehighlight(false),
     completer(new QCompleter(this)),
     complPopupShowingInfo(false),
     phraseModel(NULL),
     stackHighlightStart(-1),
     translationDBconfigured(false),
-    watcher(NULL),
     fcodec(NULL),
     fcodecUtfBom(false),
     lastFindWrapped(false),
@@ -100,7 +107,9 @@ TDriverCodeTextEdit::TDriverCodeTextEdit(QWidget *parent) :
     popupWasTriggered(false),
     contextEval(new QAction(this)),
     ignoreCursorPosChanges(false),
-    needRehighlightAfterCursorPosChange(false)
+    needRehighlightAfterCursorPosChange(false),
+    dirtyHighlightLayers(AllHighlightLayers),
+    highlightTimer(new QTimer(this))
 {
     // fix selection color when not focused
     {
@@ -109,6 +118,9 @@ TDriverCodeTextEdit::TDriverCodeTextEdit(QWidget *parent) :
                      pal.color(QPalette::Active, QPalette::Highlight).lighter(120));
         setPalette(pal);
     }
+    connect(TDriverFileWatcher::globalInstance(), SIGNAL(filesChanged(QObject*,QStringList)),
+            SLOT(watchedFilesChanged(QObject*,QStringList)));
+
     // read ruby phrases from completions definition file
     QStringList phrases;
     MEC::DefinitionFileType type = MEC::getDefinitionFile(
@@ -149,6 +161,11 @@ TDriverCodeTextEdit::TDriverCodeTextEdit(QWidget *parent) :
     contextEval->setShortcut(tr("Ctrl+Alt+I"));
     connect(contextEval, SIGNAL(triggered()), this, SLOT(doInteractiveEval()));
 
+    // extra selections are updated at most once per frame
+    highlightTimer->setSingleShot(true);
+    highlightTimer->setInterval(16);
+    connect(highlightTimer, SIGNAL(timeout()), this, SLOT(applyHighlights()));
+
     updateSideAreaWidth();
     updateHighlights();
 }
@@ -173,6 +190,7 @@ void TDriverCodeTextEdit::setRubyMode(bool enabled)
 {
     if (enabled != isRubyMode) {
         isRubyMode = enabled;
+        blockStructure->setRubyMode(enabled);
         //        if (enabled)
         //            isUsingTabulatorsMode = false;
         emit modesChanged();
@@ -230,6 +248,13 @@ void TDriverCodeTextEdit::updateSideArea(const QRect &rect, int dy)
     if (rect.contains(viewport()->rect())) {
         updateSideAreaWidth();
     }
+
+    // blocks scrolled into view are highlighted before the rest of the document
+    if (highlighter && highlighter->document() == document() && highlighter->isIncrementalPending()) {
+        int first, last;
+        visibleBlockRange(first, last);
+        highlighter->setPriorityBlocks(first, last);
+    }
 }
 
 
@@ -318,7 +343,7 @@ void TDriverCodeTextEdit::completerActivated(const QModelIndex &index)
         lastBaseText.clear();
 
         popupCompleterInfo(tr("CTRL+I to continue completion."));
-        updateHighlights();
+        scheduleHighlights(CompletionLayer);
         break;
 
     default:
@@ -426,7 +451,13 @@ void TDriverCodeTextEdit::doAutoIndent(QKeyEvent *event)
     if (event->key() != Qt::Key_Return && event->key() != Qt::Key_Enter) return; // not newline
     QTextBlock bl = textCursor().block().previous();
     if (!bl.isValid()) return; // no valid previous block
-    insertAtTextCursor(bl.text().left(countIndentChars(bl.text())));
+
+    QString indent = bl.text().left(countIndentChars(bl.text()));
+    if (isRubyMode && blockStructure->blockOpenCount(bl.blockNumber()) > 0) {
+        // previous line opened a block, indent one level deeper
+        indent += (isUsingTabulatorsMode) ? QString('\t') : QString(indentSizeForSpaceMode, ' ');
+    }
+    insertAtTextCursor(indent);
 }
 
 
@@ -902,7 +933,7 @@ bool TDriverCodeTextEdit::doInteractiveCompletion(QKeyEvent *event)
             setTextCursor(complCur);
             complCur.setPosition(selStart);
             complCur.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor, selText.size() + evText.size());
-            updateHighlights();
+            scheduleHighlights(CompletionLayer);
         }
 
         if (special == StackPush) {
@@ -993,6 +1024,14 @@ void TDriverCodeTextEdit::tryInteractiveCompletion(QKeyEvent *)
         popupCompleterInfo(tr("Type text to start completion..."));
         lastBaseText.clear();
     }
+    else if (newBaseText.isEmpty() && popupSymbolCompletion()) {
+        // plain name completed from symbol index, ruby is needed only for methods of objects
+        lastBaseText.clear();
+    }
+    else if (popupCachedCompletion(newBaseText)) {
+        // same receiver was completed after last evaluation, no need to ask ruby
+        lastBaseText = newBaseText;
+    }
     else if (lastBaseText == newBaseText) {
         popupCompleterInfo(tr("Searching completions for:\n") + lastBaseText);
         emit requestInteractiveCompletion(MEC::replaceUnicodeSeparators(lastBaseText).toLocal8Bit());
@@ -1014,6 +1053,12 @@ void TDriverCodeTextEdit::popupInteractiveCompletion(QObject *client, QByteArray
 
     if (!completer->popup()->isVisible() || completionType != BASIC_COMPLETION || complCur.isNull()) return; // obsolete signal received
 
+    popupCompletionList(completions);
+}
+
+
+void TDriverCodeTextEdit::popupCompletionList(const QStringList &completions)
+{
     QStandardItemModel *model = new QStandardItemModel(completer);
 
     for(int ii = 0; ii<completions.size(); ++ii) {
@@ -1033,6 +1078,83 @@ void TDriverCodeTextEdit::popupInteractiveCompletion(QObject *client, QByteArray
 }
 
 
+bool TDriverCodeTextEdit::popupCachedCompletion(const QString &baseText)
+{
+    if (!completionCache || complCur.isNull()) return false;
+
+    const QByteArray statement(MEC::replaceUnicodeSeparators(baseText).toLocal8Bit());
+    if (!completionCache->contains(statement)) return false;
+
+    if (completionCache->completions(statement, complCur.selectedText()).isEmpty()) {
+        popupCompleterInfo(tr("No completions for:\n") + baseText + complCur.selectedText());
+    }
+    else {
+        // whole list to model, completer filters it while typing and erasing
+        popupCompletionList(completionCache->completions(statement));
+    }
+    return true;
+}
+
+
+bool TDriverCodeTextEdit::popupSymbolCompletion()
+{
+    if (!symbolIndex || complCur.isNull()) return false;
+
+    const QStringList names = symbolIndex->completions(complCur.selectedText());
+    if (names.isEmpty()) return false;
+
+    popupCompletionList(names);
+    return true;
+}
+
+
+void TDriverCodeTextEdit::gotoDefinition()
+{
+    if (!symbolIndex) return;
+
+    QList<TDriverSymbolIndex::Location> locations;
+    QString name;
+    QTextCursor cur(textCursor());
+
+    if (fname.endsWith(".feature")) {
+        // step in a feature file, find step definitions matching it
+        static const QRegExp keywordEx("^\\s*(Given|When|Then|And|But)\\s+");
+        name = cur.block().text();
+        name.remove(keywordEx);
+        name = name.trimmed();
+        locations = symbolIndex->stepDefinitions(name);
+    }
+    else {
+        cur.select(QTextCursor::WordUnderCursor);
+        name = cur.selectedText();
+        locations = symbolIndex->definitions(name);
+        // word selection excludes sigils of instance and class variables
+        if (locations.isEmpty()) locations = symbolIndex->definitions("@" + name);
+        if (locations.isEmpty()) locations = symbolIndex->definitions("@@" + name);
+    }
+
+    const QPoint popupPos(viewport()->mapToGlobal(cursorRect().bottomLeft()));
+
+    if (locations.isEmpty()) {
+        QToolTip::showText(popupPos, tr("No definition found for '%1'").arg(MEC::textShortened(name, 40, 20)), this);
+    }
+    else if (locations.size() == 1) {
+        emit requestGotoLine(QString("%1:%2").arg(locations.first().fileName).arg(locations.first().line));
+    }
+    else {
+        QMenu menu(this);
+        foreach (const TDriverSymbolIndex::Location &location, locations) {
+            QString spec(QString("%1:%2").arg(location.fileName).arg(location.line));
+            QAction *action = menu.addAction(QString("%1:%2").arg(QFileInfo(location.fileName).fileName()).arg(location.line));
+            action->setData(spec);
+            action->setToolTip(spec);
+        }
+        QAction *chosen = menu.exec(popupPos);
+        if (chosen) emit requestGotoLine(chosen->data().toString());
+    }
+}
+
+
 void TDriverCodeTextEdit::errorInteractiveCompletion(QObject *client, QByteArray statement, QStringList completions)
 {
     Q_UNUSED(completions);
@@ -1126,7 +1248,7 @@ void TDriverCodeTextEdit::keyPressEvent(QKeyEvent *event)
     }
 
     if (!oldComplCur.isCopyOf(complCur)) {
-        updateHighlights();
+        scheduleHighlights(CompletionLayer);
     }
 }
 
@@ -1185,7 +1307,7 @@ void TDriverCodeTextEdit::cursorPositionChange()
     if (ignoreCursorPosChanges) return;
 
     QTextCursor cur(textCursor());
-    bool hlUpdate = false;
+    int hlLayers = 0;
 
     //qDebug() << FCFL << cur.position() << completionType;
     if (completionType != NO_COMPLETION) {
@@ -1195,7 +1317,7 @@ void TDriverCodeTextEdit::cursorPositionChange()
         if (cur.position() < complCur.selectionStart() || cur.position() > complCur.selectionEnd() ) {
             //qDebug() << FCFL << "cancelCompletion";
             cancelCompletion();
-            hlUpdate = true;
+            hlLayers |= CompletionLayer | CursorLineLayer | BlockDelimiterLayer;
         }
         else {
             cur.setPosition(complCur.selectionEnd());
@@ -1206,29 +1328,28 @@ void TDriverCodeTextEdit::cursorPositionChange()
     else {
         int block = cur.block().blockNumber();
         if (block != lastBlock) {
-            hlUpdate = true;
+            hlLayers |= CursorLineLayer | BlockDelimiterLayer;
             lastBlock = block;
         }
     }
 
     if (needRehighlightAfterCursorPosChange) {
-        hlUpdate = true;
+        hlLayers |= BlockDelimiterLayer;
         needRehighlightAfterCursorPosChange = false;
     }
 
-    if (!hlUpdate) hlUpdate = testBlockDelimiterHighlight();
+    if (!(hlLayers & BlockDelimiterLayer) && testBlockDelimiterHighlight()) hlLayers |= BlockDelimiterLayer;
 
-    if (hlUpdate) updateHighlights();
+    if (hlLayers) scheduleHighlights(hlLayers);
 }
 
 void TDriverCodeTextEdit::madeCurrent()
 {
     //qDebug() << FCFL << fileName();
     // if this has focus or is visible, start using highlighter
-    if (highlighter) {
-        highlighter->setDocument(document());
+    if (highlighter && highlighter->document() != document()) {
         //qDebug() << FCFL << "doing rehighlight";
-        highlighter->rehighlight();
+        doSyntaxHighlight();
     }
 }
 
@@ -1414,7 +1535,7 @@ void TDriverCodeTextEdit::setRunning(bool state)
 {
     //qDebug() << FCFL << fileName() << state;
     isRunning = state;
-    updateHighlights();
+    scheduleHighlights(BreakpointLayer | RunningLineLayer);
 }
 
 
@@ -1453,15 +1574,15 @@ void TDriverCodeTextEdit::setFileName(QString fn, bool onlySetModes)
             emit modesChanged();
         }
     }
-    if (watcher) qDebug() << FCFL << fname << "watching changes:" << watcher->files() << watcher->directories();
+    if (!watchedName.isEmpty()) qDebug() << FCFL << fname << "watching changes:" << watchedName;
     else qDebug() << FCFL << "not watching for changes";
 }
 
 
 void TDriverCodeTextEdit::focusInEvent(QFocusEvent *event)
 {
-    if (highlighter) {
-        highlighter->setDocument(document());
+    if (highlighter && highlighter->document() != document()) {
+        doSyntaxHighlight();
     }
     QPlainTextEdit::focusInEvent(event);
 }
@@ -1477,38 +1598,83 @@ void TDriverCodeTextEdit::resizeEvent(QResizeEvent *event)
 
 void TDriverCodeTextEdit::updateHighlights()
 {
-    update(sideArea->rect());
+    scheduleHighlights(AllHighlightLayers);
+}
 
-    if (needSyntaxRehighlight) doSyntaxHighlight();
 
-    QList<QTextEdit::ExtraSelection> extraSelections;
+void TDriverCodeTextEdit::scheduleHighlights(int layers)
+{
+    dirtyHighlightLayers |= layers;
+    // not restarted if already active, so updates are not postponed by continuous changes
+    if (!highlightTimer->isActive()) highlightTimer->start();
+}
 
-    highlightCursorLine(extraSelections);
 
-    if (isRunning) {
-        highlightBreakpointLines(extraSelections);
-        highlightRunningLine(extraSelections);
-    }
+void TDriverCodeTextEdit::applyHighlights()
+{
+    update(sideArea->rect());
 
-    highlightCompletionCursors(extraSelections);
+    if (needSyntaxRehighlight) doSyntaxHighlight();
 
-    highlightBlockDelimiters(extraSelections);
+    // cursors of cached selections follow document edits
+    if (dirtyHighlightLayers & CursorLineLayer) {
+        cursorLineSelections.clear();
+        highlightCursorLine(cursorLineSelections);
+    }
+    if (dirtyHighlightLayers & BreakpointLayer) {
+        breakpointSelections.clear();
+        if (isRunning) highlightBreakpointLines(breakpointSelections);
+    }
+    if (dirtyHighlightLayers & RunningLineLayer) {
+        runningLineSelections.clear();
+        if (isRunning) highlightRunningLine(runningLineSelections);
+    }
+    if (dirtyHighlightLayers & CompletionLayer) {
+        completionSelections.clear();
+        highlightCompletionCursors(completionSelections);
+    }
+    if (dirtyHighlightLayers & BlockDelimiterLayer) {
+        blockDelimiterSelections.clear();
+        highlightBlockDelimiters(blockDelimiterSelections);
+    }
+    dirtyHighlightLayers = 0;
 
-    setExtraSelections(extraSelections);
+    setExtraSelections(cursorLineSelections
+                       + breakpointSelections
+                       + runningLineSelections
+                       + completionSelections
+                       + blockDelimiterSelections);
 }
 
 
 void TDriverCodeTextEdit::doSyntaxHighlight()
 {
     if (highlighter) {
-        highlighter->rehighlight();
-        // TODO: if completion selection becomes sluggish, do highlight only to visible blocks,
-        // see sideAreaPaintEvent for example
+        int first, last;
+        visibleBlockRange(first, last);
+        highlighter->highlightIncrementally(document(), first, last);
         needSyntaxRehighlight = false;
     }
 }
 
 
+// block numbers of first and last block at least partially inside viewport
+void TDriverCodeTextEdit::visibleBlockRange(int &first, int &last)
+{
+    QTextBlock block = firstVisibleBlock();
+    first = last = block.blockNumber();
+
+    int top = (int)blockBoundingGeometry(block).translated(contentOffset()).top();
+    const int bottom = viewport()->height();
+
+    while (block.isValid() && top <= bottom) {
+        last = block.blockNumber();
+        top += (int) blockBoundingRect(block).height();
+        block = block.next();
+    }
+}
+
+
 bool TDriverCodeTextEdit::testBlockDelimiterHighlight()
 {
     QTextCursor cur(textCursor());
@@ -1554,14 +1720,31 @@ void TDriverCodeTextEdit::highlightBlockDelimiters(QList<QTextEdit::ExtraSelecti
                 selection.cursor = cur;
                 selection.format.setForeground(pairMatchColor);
 
-                if (MEC::findNestedPair(delimCh.toLatin1(), cur)) {
+                TDriverBlockStructure::PairResult result = blockStructure->findPair(cur);
+                bool wholeDocument = true;
+
+                if (result == TDriverBlockStructure::NoDelimiter) {
+                    // brace inside string or comment, search only visible text for a pair
+                    int firstNum, lastNum;
+                    visibleBlockRange(firstNum, lastNum);
+                    QTextBlock startBlock = document()->findBlockByNumber(firstNum);
+                    QTextBlock endBlock = document()->findBlockByNumber(lastNum);
+                    int startLimit = startBlock.position();
+                    int endLimit = endBlock.position() + endBlock.length() - 1;
+                    wholeDocument = (!startBlock.previous().isValid() && !endBlock.next().isValid());
+                    if (MEC::findNestedPair(delimCh.toLatin1(), cur, startLimit, endLimit)) {
+                        result = TDriverBlockStructure::Matched;
+                    }
+                }
+
+                if (result == TDriverBlockStructure::Matched) {
                     // highlight both members of brace char pair with same color
                     QTextEdit::ExtraSelection selection2;
                     selection2.format.setForeground(pairMatchColor);
                     selection2.cursor = cur;
                     extraSelections.append(selection2);
                 }
-                else {
+                else if (wholeDocument) {
                     // highlight pairless brace char background to indicate possible error
                     selection.format.setBackground(pairNoMatchBgColor);
                 }
@@ -1843,7 +2026,7 @@ void TDriverCodeTextEdit::clearBreakpoints()
     }
 
     bpList.clear();
-    updateHighlights();
+    scheduleHighlights(BreakpointLayer);
 }
 
 
@@ -1863,7 +2046,7 @@ void TDriverCodeTextEdit::rdebugBreakpointReset()
     rdebugBpSet.clear();
     rdebugBpSet.reserve(setCapacity);
 
-    updateHighlights();
+    scheduleHighlights(BreakpointLayer);
 }
 
 
@@ -1909,7 +2092,7 @@ void TDriverCodeTextEdit::rdebugBreakpoint(MEC::Breakpoint bp)
         }
     }
 
-    updateHighlights();
+    scheduleHighlights(BreakpointLayer);
 }
 
 void TDriverCodeTextEdit::removeBreakpointLine(int lineNum)
@@ -1930,7 +2113,7 @@ void TDriverCodeTextEdit::removeBreakpointLine(int lineNum)
         } while (ind < bpList.size() && bpList[ind].line == lineNum);
     }
 
-    updateHighlights();
+    scheduleHighlights(BreakpointLayer);
 }
 
 
@@ -1955,7 +2138,7 @@ void TDriverCodeTextEdit::rdebugDelBreakpoint(int rdebugInd)
 
     Q_ASSERT(count == 1); // rdebugBpSet use must make sure this holds!
 
-    updateHighlights();
+    scheduleHighlights(BreakpointLayer);
     if (count > 1) qDebug() << FCFL << "Removed multiple breakpoints with same rdebug breakpoint index" << rdebugInd;
 }
 
@@ -1985,7 +2168,7 @@ void TDriverCodeTextEdit::uiToggleBreakpointLine(int lineNum)
         Q_ASSERT(ind+1 == bpList.size() || bpList[ind+1].line > lineNum);
     }
 
-    updateHighlights();
+    scheduleHighlights(BreakpointLayer);
 }
 
 
@@ -2019,7 +2202,7 @@ void TDriverCodeTextEdit::setRunningLine(int lineNum)
     if (lineNum == runningLine) return; // no change, avoid updates below
 
     runningLine = (lineNum > 0 && lineNum <= document()->blockCount()) ? lineNum : 0;
-    updateHighlights();
+    scheduleHighlights(RunningLineLayer);
     // TODO: change cursor position to running line? or just scroll document to running line without changing cursor position?
 }
 
@@ -2144,16 +2327,21 @@ void TDriverCodeTextEdit::fileChanged(const QString &path)
     QMessageBox::warning(this, tr("Open file has changed on disk"), text);
 }
 
+void TDriverCodeTextEdit::watchedFilesChanged(QObject *client, QStringList paths)
+{
+    if (client != this) return; // not for us
+    if (paths.contains(watchedName)) fileChanged(watchedName);
+}
+
+
 void TDriverCodeTextEdit::enableWatcher()
 {
-    if (watcher) {
-        delete watcher;
-        watcher = NULL;
-    }
+    disableWatcher();
 
     if (!fname.isEmpty()) {
-        watcher = new QFileSystemWatcher((QStringList() << fname), this);
-        connect(watcher, SIGNAL(fileChanged(QString)), SLOT(fileChanged(QString)));
+        // content is hashed now, so own save will not be reported as change
+        watchedName = fname;
+        TDriverFileWatcher::globalInstance()->watch(watchedName, this);
         qDebug() << FCFL << fname;
     }
     else {
@@ -2163,10 +2351,10 @@ void TDriverCodeTextEdit::enableWatcher()
 
 void TDriverCodeTextEdit::disableWatcher()
 {
-    if (watcher) {
-        qDebug() << FCFL << "with" << watcher->files() << watcher->directories();
-        delete watcher;
-        watcher = NULL;
+    if (!watchedName.isEmpty()) {
+        qDebug() << FCFL << "with" << watchedName;
+        TDriverFileWatcher::globalInstance()->unwatch(watchedName, this);
+        watchedName.clear();
     }
     else {
         qDebug() << FCFL << "already disabled";
@@ -39,8 +39,11 @@ class QAbstractItemModel;
 class QModelIndex;
 class QCompleter;
 class QFont;
-class QFileSystemWatcher;
 class QTextCodec;
+class QTimer;
+class TDriverBlockStructure;
+class TDriverSymbolIndex;
+class TDriverCompletionCache;
 // contains line numbers, breakpoints, etc.
 class SideArea;
 //class QMenu;
@@ -73,6 +76,8 @@ public:
     void sideAreaMouseReleaseEvent(QMouseEvent *event);
 
     void setHighlighter(TDriverHighlighter *);
+    void setSymbolIndex(TDriverSymbolIndex *index) { symbolIndex = index; }
+    void setCompletionCache(const TDriverCompletionCache *cache) { completionCache = cache; }
 
     const QString &fileName() const { return fname; }
     void setFileName(QString name, bool onlySetModes=false); // emits modesChanged()
@@ -95,6 +100,7 @@ signals:
     void removedBreakpoint(int rdebugInd);
     void requestInteractiveCompletion(QByteArray statement);
     void requestInteractiveEvaluation(QByteArray statement);
+    void requestGotoLine(QString fileLineSpec);
 
 public slots:
     void setUsingTabulatorsMode(bool enabled);
@@ -131,6 +137,7 @@ public slots:
     bool doInteractiveCompletion(QKeyEvent *);
     void popupInteractiveCompletion(QObject *client, QByteArray statement=QByteArray(), QStringList completions=QStringList());
     void errorInteractiveCompletion(QObject *client, QByteArray statement, QStringList completions);
+    void gotoDefinition();
 
     //void errorInteractiveEvaluation() { implement when needed }
 
@@ -164,6 +171,9 @@ private:
     const int noNameId;
     QWidget *sideArea;
     TDriverHighlighter *highlighter;
+    TDriverBlockStructure *blockStructure;
+    TDriverSymbolIndex *symbolIndex;
+    const TDriverCompletionCache *completionCache;
     bool needSyntaxRehighlight;
     QCompleter *completer;
     bool complPopupShowingInfo;
@@ -185,7 +195,7 @@ private:
     QStringList translationDBerrors;
 
     QString fname;
-    QFileSystemWatcher *watcher;
+    QString watchedName;
     QTextCodec *fcodec;
     bool fcodecUtfBom;
 
@@ -222,6 +232,24 @@ private:
     bool ignoreCursorPosChanges;
     bool needRehighlightAfterCursorPosChange;
 
+    // extra selection layers, each rebuilt only when invalidated by its own trigger
+    enum HighlightLayer {
+        CursorLineLayer = 0x01,
+        BreakpointLayer = 0x02,
+        RunningLineLayer = 0x04,
+        CompletionLayer = 0x08,
+        BlockDelimiterLayer = 0x10,
+        AllHighlightLayers = 0x1f
+    };
+    void scheduleHighlights(int layers);
+    int dirtyHighlightLayers;
+    QTimer *highlightTimer;
+    QList<QTextEdit::ExtraSelection> cursorLineSelections;
+    QList<QTextEdit::ExtraSelection> breakpointSelections;
+    QList<QTextEdit::ExtraSelection> runningLineSelections;
+    QList<QTextEdit::ExtraSelection> completionSelections;
+    QList<QTextEdit::ExtraSelection> blockDelimiterSelections;
+
 private slots:
     void updateSideAreaWidth();
 
@@ -232,9 +260,12 @@ private slots:
 
     void documentBlockCountChange(int newCount);
     void fileChanged(const QString &path);
+    void watchedFilesChanged(QObject *client, QStringList paths);
 
     // highlight slots are usually not connect, but called by handleCursorPositionChange
+    void applyHighlights();
     void doSyntaxHighlight();
+    void visibleBlockRange(int &first, int &last);
     bool testBlockDelimiterHighlight();
     void highlightBlockDelimiters(QList<QTextEdit::ExtraSelection> &extraSelections);
     void highlightCursorLine(QList<QTextEdit::ExtraSelection> &extraSelections);
@@ -249,6 +280,9 @@ private slots:
 
 private:
     bool doTabHandling(QKeyEvent *);
+    bool popupSymbolCompletion();
+    bool popupCachedCompletion(const QString &baseText);
+    void popupCompletionList(const QStringList &completions);
     void indentSelection(QTextCursor tc, bool increaseIndentation);
     void reindentSelectionStart(QTextCursor tc, int indLevel, int indChars);
     bool forwardSearch(int targetLine, int &ind);
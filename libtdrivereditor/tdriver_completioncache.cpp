@@ -0,0 +1,84 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#include "tdriver_completioncache.h"
+
+#include <QSet>
+
+#include <algorithm>
+
+
+TDriverCompletionCache::TDriverCompletionCache(int maxReceivers) :
+    cache(maxReceivers)
+{
+}
+
+
+bool TDriverCompletionCache::contains(const QByteArray &receiver) const
+{
+    return cache.contains(receiver.trimmed());
+}
+
+
+QStringList TDriverCompletionCache::completions(const QByteArray &receiver, const QString &prefix) const
+{
+    const Entry *entry = cache.object(receiver.trimmed());
+    if (!entry) return QStringList();
+    if (prefix.isEmpty()) return entry->items;
+
+    // items starting with prefix form a continuous range in sorted list
+    QStringList result;
+    QStringList::const_iterator it = std::lower_bound(entry->sorted.constBegin(), entry->sorted.constEnd(), prefix);
+    for (; it != entry->sorted.constEnd() && it->startsWith(prefix); ++it) {
+        result << *it;
+    }
+    return result;
+}
+
+
+void TDriverCompletionCache::insert(const QByteArray &receiver, const QStringList &completions)
+{
+    Entry *entry = new Entry;
+    QSet<QString> seen;
+
+    foreach (const QString &completion, completions) {
+        QString item(completion.trimmed());
+        if (item.isEmpty() || seen.contains(item)) continue;
+        seen.insert(item);
+        entry->items << item;
+    }
+
+    if (entry->items.isEmpty()) {
+        // failed completion, ruby will be asked again
+        delete entry;
+        cache.remove(receiver.trimmed());
+        return;
+    }
+
+    entry->sorted = entry->items;
+    entry->sorted.sort();
+    cache.insert(receiver.trimmed(), entry);
+}
+
+
+void TDriverCompletionCache::clear()
+{
+    cache.clear();
+}
@@ -0,0 +1,54 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#ifndef TDRIVER_COMPLETIONCACHE_H
+#define TDRIVER_COMPLETIONCACHE_H
+
+#include "libtdrivereditor_global.h"
+
+#include <QByteArray>
+#include <QCache>
+#include <QStringList>
+
+
+// Completion lists received from interactive Ruby, keyed by receiver expression
+// (the statement part before completed text, for example "sut.application.").
+// Cached lists are valid only until next evaluation or reset of Ruby instance.
+class LIBTDRIVEREDITORSHARED_EXPORT TDriverCompletionCache
+{
+public:
+    explicit TDriverCompletionCache(int maxReceivers = 100);
+
+    bool contains(const QByteArray &receiver) const;
+    QStringList completions(const QByteArray &receiver, const QString &prefix = QString()) const;
+
+    void insert(const QByteArray &receiver, const QStringList &completions);
+    void clear();
+
+private:
+    struct Entry {
+        QStringList items; // original order from ruby
+        QStringList sorted; // for finding prefix ranges
+    };
+
+    QCache<QByteArray, Entry> cache;
+};
+
+#endif // TDRIVER_COMPLETIONCACHE_H
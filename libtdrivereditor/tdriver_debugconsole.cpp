@@ -29,7 +29,7 @@
 #include <QTcpSocket>
 #include <QStringList>
 #include <QMap>
-#include <QRegExp>
+#include <QTimer>
 
 #include <QLineEdit>
 #include <QHBoxLayout>
@@ -66,7 +66,8 @@ TDriverDebugConsole::TDriverDebugConsole(QWidget *parent) :
 
         remoteParseKey(),
         remoteParsedLast(NULL),
-        remoteParsedNew(new QMap<QString, QStringList>)
+        remoteParsedNew(new QMap<QString, QStringList>),
+        pipelinedPrompts(0)
 {
     remoteConsole->outputFormat.setForeground(QBrush(Qt::darkBlue));
     remoteConsole->commandFormat.setForeground(QBrush(Qt::blue));
@@ -203,6 +204,9 @@ void TDriverDebugConsole::setRunning(bool state)
 
     remoteCmdQueue.clear();
     controlCmdQueue.clear();
+    breakpointCmds.clear();
+    remoteBreakpoints.clear();
+    pipelinedPrompts = 0;
 
     dataSynced =
             syncingBeforeContinue =
@@ -400,6 +404,24 @@ bool TDriverDebugConsole::sendControlCmd(QString cmd, bool allowQueuing)
 }
 
 
+void TDriverDebugConsole::flushBreakpointCmds()
+{
+    if (breakpointCmds.isEmpty() || !remoteHasPrompt) return; // will be called again when prompt arrives
+
+    qDebug() << FFL << "WRITE" << breakpointCmds.size() << "pipelined commands";
+    remoteConn->write((breakpointCmds.join("\n") + "\n").toLocal8Bit());
+    foreach (const QString &cmd, breakpointCmds) {
+        remoteConsole->appendLine(cmd, remoteConsole->commandFormat);
+    }
+
+    // rdebug replies to each command with a prompt, only the last one gives control back
+    pipelinedPrompts = breakpointCmds.size() - 1;
+    breakpointCmds.clear();
+    remoteHasPrompt = false;
+    updateActionStates();
+}
+
+
 void TDriverDebugConsole::doContinueOrDelegate(void)
 {
     if (isRunning) {
@@ -442,45 +464,32 @@ static inline void dumpToConsole(TDriverConsoleTextEdit *console, QMap<QString,
     }
 }
 
-static QList<struct MEC::Breakpoint> parseBreakpoints(QStringList list)
+// parses one trimmed line of rdebug breakpoint list, format "<num> <y|n> at <file>:<line>"
+static bool parseBreakpointLine(const QString &line, struct MEC::Breakpoint &bp)
 {
-    static const QRegExp rx("^(\\d+) +([yn]) +at +(.+):(\\d+)$");
-    //obsolete parsing from control: "^Breakpoint (\\d+) file (.+), line (\\d+)$");
+    static const QString atSeparator(" at ");
 
-    QList<struct MEC::Breakpoint> result;
-    if (list.isEmpty()) return result;
+    int atPos = line.indexOf(atSeparator);
+    int colonPos = line.lastIndexOf(':');
+    if (atPos < 0 || colonPos <= atPos + atSeparator.size()) return false;
 
-    QString firstline(list.takeFirst());
-    if (list.isEmpty() || firstline != QObject::tr("Num Enb What", "rdebug header for breakpoint list printout")) {
-        if (firstline != QObject::tr("No breakpoints.", "rdebug printout for no breakpoints")) {
-            qWarning() << FFL << "UNEXPECTED OUTPUT FROM rdebug, PLEASE REPORT A TICKET";
-            qDebug() << "breakpoint list:" << list;
-        }
-        return result;
-    }
+    QStringList head(line.left(atPos).split(' ', QString::SkipEmptyParts));
+    if (head.size() != 2 || (head.at(1) != "y" && head.at(1) != "n")) return false;
 
-    foreach (QString line, list) {
-        if (rx.indexIn(line) == -1 || rx.capturedTexts().size() != 1+4) {
-            qWarning() << FFL << "Invalid breakpoint line ignored:" << line;
-            qDebug() << FFL << "captures:" << rx.capturedTexts()
-                    << "pattern:" << rx.pattern();
-            continue;
-        }
+    bool ok1, ok2;
+    bp.num = head.at(0).toInt(&ok1);
+    bp.enabled = (head.at(1) == "y");
+    bp.file = line.mid(atPos + atSeparator.size(), colonPos - atPos - atSeparator.size()).trimmed();
+    bp.line = line.mid(colonPos + 1).toInt(&ok2);
+
+    return ok1 && ok2 && !bp.file.isEmpty();
+}
 
-        bool ok1, ok4;
-        struct MEC::Breakpoint bp(
-                rx.cap(1).toInt(&ok1),
-                (rx.cap(2) == "y"),
-                rx.cap(3),
-                rx.cap(4).toInt(&ok4) );
-        if (ok1 && ok4)
-            result.append(bp);
-        else
-            qDebug() << FFL << "invalid parse result" << ok1 << ok4 << "for line" << line;
-    }
 
-    qDebug() << FFL << MEC::dumpBreakpointList(result, "\n  ", "\n  ");
-    return result;
+static inline bool isBreakpointListHeader(const QString &line)
+{
+    return (line == QObject::tr("Num Enb What", "rdebug header for breakpoint list printout")
+            || line == QObject::tr("No breakpoints.", "rdebug printout for no breakpoints"));
 }
 
 static inline bool checkForPrompt(const QString &str, const QString &prefix)
@@ -508,7 +517,16 @@ void TDriverDebugConsole::handleRemoteText(QString text)
 
         qDebug() << FCFL << str << remoteParseKey;
 
-        if (checkForPrompt(str, remotePromptPrefix)) {
+        if (checkForPrompt(str, remotePromptPrefix) && pipelinedPrompts > 0) {
+            // reply to one of pipelined commands, show errors but don't process state before the last reply
+            --pipelinedPrompts;
+            foreach(const QString &line, remoteParsedNew->value("error-begin"))
+                remoteConsole->appendLine("ERROR: "+line, remoteConsole->outputFormat);
+            remoteParsedNew->clear();
+            remoteBreakpoints.clear();
+            remoteParseKey.clear();
+        }
+        else if (checkForPrompt(str, remotePromptPrefix)) {
             // got prompt, we're back in control
             if (!remoteHasPrompt) qDebug() << FCFL << "REMOTE GOT PROMPT by" << str;
             remoteHasPrompt = true;
@@ -537,13 +555,16 @@ void TDriverDebugConsole::handleRemoteText(QString text)
             foreach(const QString &line, remoteParsedLast->value("error-begin"))
                 remoteConsole->appendLine("ERROR: "+line, remoteConsole->outputFormat);
 
-            emit breakpoints(parseBreakpoints(remoteParsedLast->value("breakpoints")));
+            qDebug() << FFL << MEC::dumpBreakpointList(remoteBreakpoints, "\n  ", "\n  ");
+            emit breakpoints(remoteBreakpoints);
+            remoteBreakpoints.clear();
             emitRunningPosition(*remoteParsedLast, false);
 
             interruptSent = false;
             if (quitWaiting) doQuit();
 
-            sendRemoteCmd(); // handle remoteCmdQueue
+            flushBreakpointCmds(); // includes commands added by requestDataSync above
+            if (remoteHasPrompt) sendRemoteCmd(); // handle remoteCmdQueue
             //            if (remoteHasPrompt) {
             //                remoteConsole->appendText("> ", remoteConsole->commandFormat);
             //            }
@@ -558,12 +579,20 @@ void TDriverDebugConsole::handleRemoteText(QString text)
             // "starting" means script is running and rdebug remote will not be responsive
             if (remoteParseKey == "starting") {
                 remoteParsedNew->clear();
+                remoteBreakpoints.clear();
                 if (procConsoleOwner) procConsoleOwner->setStdStreamsHidden(false);
             }
         }
         else if (!remoteParseKey.isEmpty()) {
             // got new information item for current key
-            (*remoteParsedNew)[remoteParseKey].append(str.trimmed());
+            QString item(str.trimmed());
+            (*remoteParsedNew)[remoteParseKey].append(item);
+
+            if (remoteParseKey == "breakpoints" && pipelinedPrompts == 0 && !isBreakpointListHeader(item)) {
+                struct MEC::Breakpoint bp;
+                if (parseBreakpointLine(item, bp)) remoteBreakpoints.append(bp);
+                else qWarning() << FFL << "Invalid breakpoint line ignored:" << item;
+            }
         }
         else {
             remoteConsole->appendLine(str, remoteConsole->outputFormat);
@@ -707,8 +736,8 @@ void TDriverDebugConsole::addBreakpoint(struct MEC::Breakpoint bp)
     }
     Q_ASSERT(bp.num <= 0);
     Q_ASSERT(bp.enabled == true);
-    QString cmd(QString("break %1:%2").arg(bp.file).arg(bp.line));
-    sendRemoteCmd(cmd, true);
+    breakpointCmds.append(QString("break %1:%2").arg(bp.file).arg(bp.line));
+    QTimer::singleShot(0, this, SLOT(flushBreakpointCmds()));
     //    if (sendRemoteCmd(cmd, true)) qDebug() << FCFL << "Sent to remote:" << cmd;
     //else qDebug() << FCFL << "Remote busy. Command not sent:" << cmd;
 }
@@ -720,8 +749,8 @@ void TDriverDebugConsole::removeBreakpoint(int rdebugInd)
         qDebug() << FCFL << "not running, ignored";
         return;
     }
-    QString cmd(QString("delete %1").arg(rdebugInd));
-    sendRemoteCmd(cmd, false);
+    breakpointCmds.append(QString("delete %1").arg(rdebugInd));
+    QTimer::singleShot(0, this, SLOT(flushBreakpointCmds()));
     //    if (sendRemoteCmd(cmd)) qDebug() << FCFL << "Sent to remote:" << cmd;
     //else qDebug() << FCFL << "Remote busy. Command not sent:" << cmd;
 }
@@ -115,6 +115,11 @@ private:
 
     QMap<QString, QStringList> *remoteParsedLast;
     QMap<QString, QStringList> *remoteParsedNew;
+    QList<struct MEC::Breakpoint> remoteBreakpoints; // parsed as lines arrive
+
+    // break/delete commands are written to rdebug together, without waiting for prompt in between
+    QStringList breakpointCmds;
+    int pipelinedPrompts; // prompts still coming for pipelined commands before the last one
 
     QString remotePromptPrefix;
     QString remoteBuffer;
@@ -138,6 +143,7 @@ private slots:
     // empty but non-null cmd will send just newline, so null is needed
     bool sendRemoteCmd(QString cmd=QString(), bool allowQueuing=false);
     bool sendControlCmd(QString cmd=QString(), bool allowQueuing=false);
+    void flushBreakpointCmds();
     void emitRunningPosition(QMap<QString, QStringList> &remoteParsed, bool starting);
 };
 
@@ -30,6 +30,7 @@
 #include <QSettings>
 #include <QApplication>
 #include <QTextCursor>
+#include <QTextDocument>
 #include <QSet>
 
 #include <tdriver_debug_macros.h>
@@ -524,19 +525,19 @@ char MEC::getPair(char ch)
 }
 
 
-bool MEC::findNestedPairForward(char startCh, QTextCursor &cursor)
+bool MEC::findNestedPairForward(char startCh, QTextCursor &cursor, int endLimit)
 {
     int depth = 0;
     char endCh = getPair(startCh);
+    const QTextDocument *doc = cursor.document();
 
-    QTextCursor cur(cursor);
-    if (cur.hasSelection()) {
-        cur.setPosition(cur.selectionEnd());
-    }
+    // last position of document is after final paragraph separator
+    int end = doc->characterCount() - 1;
+    if (endLimit >= 0 && endLimit < end) end = endLimit;
 
-    while(cur.movePosition(QTextCursor::Right, QTextCursor::KeepAnchor)) {
+    for (int pos = cursor.hasSelection() ? cursor.selectionEnd() : cursor.position(); pos < end; ++pos) {
 
-        char ch = cur.selectedText().at(0).toLatin1();
+        char ch = doc->characterAt(pos).toLatin1();
         if (ch == startCh) {
             ++depth;
         }
@@ -545,29 +546,26 @@ bool MEC::findNestedPairForward(char startCh, QTextCursor &cursor)
                 --depth;
             }
             else {
-                cursor = cur;
+                cursor.setPosition(pos);
+                cursor.setPosition(pos + 1, QTextCursor::KeepAnchor);
                 return true;
             }
         }
-        cur.clearSelection();
     }
     return false;
 }
 
 
-bool MEC::findNestedPairBack(char endCh, QTextCursor &cursor)
+bool MEC::findNestedPairBack(char endCh, QTextCursor &cursor, int startLimit)
 {
     int depth = 0;
     char startCh = getPair(endCh);
+    const QTextDocument *doc = cursor.document();
 
-    QTextCursor cur(cursor);
-    if (cur.hasSelection()) {
-        cur.setPosition(cur.selectionStart());
-    }
-
-    while(cur.movePosition(QTextCursor::Left, QTextCursor::KeepAnchor)) {
+    for (int pos = (cursor.hasSelection() ? cursor.selectionStart() : cursor.position()) - 1;
+         pos >= startLimit && pos >= 0; --pos) {
 
-        char ch = cur.selectedText().at(0).toLatin1();
+        char ch = doc->characterAt(pos).toLatin1();
         if (ch == endCh) {
             ++depth;
         }
@@ -576,23 +574,23 @@ bool MEC::findNestedPairBack(char endCh, QTextCursor &cursor)
                 --depth;
             }
             else {
-                cursor = cur;
+                cursor.setPosition(pos + 1);
+                cursor.setPosition(pos, QTextCursor::KeepAnchor);
                 return true;
             }
         }
-        cur.clearSelection();
     }
     return false;
 }
 
 
-bool MEC::findNestedPair(char pair, QTextCursor &cursor)
+bool MEC::findNestedPair(char pair, QTextCursor &cursor, int startLimit, int endLimit)
 {
     char other = getPair(pair);
     if (other < pair)
-        return findNestedPairBack(pair, cursor);
+        return findNestedPairBack(pair, cursor, startLimit);
     if (other > pair)
-        return findNestedPairForward(pair, cursor);
+        return findNestedPairForward(pair, cursor, endLimit);
     else
         return false;
 }
@@ -116,22 +116,25 @@ namespace MEC {
     char getPair(char ch);
     // returns: pair of ch, or ch itself for pairless characters. paired: (){}[]<>
 
-    bool findNestedPairForward(char start, QTextCursor &cursor);
+    bool findNestedPairForward(char start, QTextCursor &cursor, int endLimit = -1);
     // finds and selectes pair of delimiter char for other, going forward from position of cur
     // pair: character for which the pair is to be found
     // cur: on success will contain the found pair as selection
+    // endLimit: position where search stops, -1 for end of document
     // returns: true on success (cur modified), false on failure (cur unmodified)
 
-    bool findNestedPairBack(char end, QTextCursor &cursor);
+    bool findNestedPairBack(char end, QTextCursor &cursor, int startLimit = 0);
     // finds and selectes pair of delimiter char for other, going back from position of cur
     // pair: character for which the pair is to be found
     // cur: on success will contain the found pair as selection
+    // startLimit: first position searched
     // returns: true on success (cur modified), false on failure (cur unmodified)
 
-    bool findNestedPair(char pair, QTextCursor &cursor);
+    bool findNestedPair(char pair, QTextCursor &cursor, int startLimit = 0, int endLimit = -1);
     // finds and selectes pair of delimiter char for other, going back or forward depending on char
     // pair: character for which the pair is to be found
     // cur: on success will contain the found pair as selection
+    // startLimit, endLimit: searched range of positions, see above
     // returns: true on success (cur modified), false on failure (cur unmodified)
 
     bool blockDelimiterOrWordUnderCursor(QTextCursor &cursor);
@@ -0,0 +1,584 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#include "tdriver_filesearchpanel.h"
+#include "tdriver_tabbededitor.h"
+#include "tdriver_codetextedit.h"
+#include "tdriver_editor_common.h"
+
+#include <QApplication>
+#include <QByteArrayMatcher>
+#include <QCheckBox>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileDialog>
+#include <QGridLayout>
+#include <QHash>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSaveFile>
+#include <QRegExp>
+#include <QSettings>
+#include <QStringMatcher>
+#include <QTextBlock>
+#include <QTextCodec>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTextStream>
+#include <QTreeWidget>
+#include <QtConcurrentMap>
+
+static const int maxMatchesPerFile = 1000;
+static const int maxShownLineLength = 200;
+static const qint64 maxSearchedFileSize = 64*1024*1024;
+static const int binaryTestLength = 8000;
+
+
+struct TextMatch {
+    int pos;
+    int length;
+    QString replacement;
+};
+
+
+// expands \0 .. \9 in replace text to captures of last match
+static QString expandReplacement(const QString &replaceText, const QRegExp &rx)
+{
+    QString ret;
+    ret.reserve(replaceText.size());
+    for (int ii = 0; ii < replaceText.size(); ++ii) {
+        const QChar ch = replaceText.at(ii);
+        if (ch == '\\' && ii+1 < replaceText.size()) {
+            const QChar next = replaceText.at(ii+1);
+            if (next.isDigit()) {
+                ret += rx.cap(next.digitValue());
+                ++ii;
+                continue;
+            }
+            else if (next == '\\') {
+                ret += next;
+                ++ii;
+                continue;
+            }
+        }
+        ret += ch;
+    }
+    return ret;
+}
+
+
+static QList<TextMatch> findMatches(const QString &text, const TDriverFileSearchPanel::Query &query,
+                                    bool withReplacements, int maxCount = -1)
+{
+    QList<TextMatch> ret;
+    if (query.text.isEmpty()) return ret;
+    const Qt::CaseSensitivity cs = (query.matchCase) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+
+    if (query.regExp) {
+        QRegExp rx(query.text, cs, QRegExp::RegExp2);
+        if (!rx.isValid()) return ret;
+
+        int pos = 0;
+        while ((pos = rx.indexIn(text, pos)) >= 0) {
+            const int len = rx.matchedLength();
+            if (len <= 0) {
+                // skip empty matches
+                ++pos;
+                continue;
+            }
+            TextMatch match = { pos, len, (withReplacements) ? expandReplacement(query.replaceText, rx) : QString() };
+            ret << match;
+            if (maxCount >= 0 && ret.size() >= maxCount) break;
+            pos += len;
+        }
+    }
+    else {
+        QStringMatcher matcher(query.text, cs);
+        const int len = query.text.size();
+
+        int pos = 0;
+        while ((pos = matcher.indexIn(text, pos)) >= 0) {
+            TextMatch match = { pos, len, query.replaceText };
+            ret << match;
+            if (maxCount >= 0 && ret.size() >= maxCount) break;
+            pos += len;
+        }
+    }
+
+    return ret;
+}
+
+
+// decodes file contents like TDriverTabbedEditor::loadFile
+static QString decodeText(const QByteArray &bytes, QTextCodec *&codec, bool &haveBom)
+{
+    codec = QTextCodec::codecForUtfText(bytes, NULL);
+    haveBom = (codec != NULL);
+    if (!codec) {
+        codec = QTextCodec::codecForName("UTF-8");
+        QTextCodec::ConverterState state;
+        QString text = codec->toUnicode(bytes.constData(), bytes.size(), &state);
+        if (state.invalidChars == 0) return text;
+        codec = QTextCodec::codecForLocale();
+    }
+    return codec->toUnicode(bytes);
+}
+
+
+static QByteArray encodeText(const QString &text, QTextCodec *codec, bool haveBom)
+{
+    QByteArray ret;
+    {
+        QTextStream stream(&ret);
+        stream.setCodec(codec);
+        stream.setGenerateByteOrderMark(haveBom);
+        stream << text;
+    }
+    return ret;
+}
+
+
+static bool isAscii(const QString &str)
+{
+    for (int ii = 0; ii < str.size(); ++ii) {
+        if (str.at(ii).unicode() > 0x7f) return false;
+    }
+    return true;
+}
+
+
+// executed in worker threads, once per file
+static TDriverFileSearchPanel::FileResult searchFile(const TDriverFileSearchPanel::FileTask &task)
+{
+    TDriverFileSearchPanel::FileResult ret;
+    ret.fileName = task.fileName;
+    QString text;
+
+    if (task.isOpen) {
+        text = task.openText;
+    }
+    else {
+        QFile file(task.fileName);
+        if (!file.open(QFile::ReadOnly) || file.size() <= 0 || file.size() > maxSearchedFileSize) return ret;
+
+        const qint64 size = file.size();
+        const uchar *data = file.map(0, size);
+        const QByteArray bytes = (data)
+                ? QByteArray::fromRawData(reinterpret_cast<const char *>(data), int(size))
+                : file.readAll();
+
+        if (QTextCodec::codecForUtfText(bytes, NULL) == NULL) {
+            // skip binary files
+            if (bytes.left(binaryTestLength).contains('\0')) return ret;
+
+            // most files don't match, case sensitive ASCII text can be rejected without decoding
+            if (task.query.matchCase && !task.query.regExp && isAscii(task.query.text)
+                    && QByteArrayMatcher(task.query.text.toLatin1()).indexIn(bytes) < 0) {
+                return ret;
+            }
+        }
+
+        QTextCodec *codec;
+        bool haveBom;
+        text = decodeText(bytes, codec, haveBom);
+    }
+
+    const QList<TextMatch> matches = findMatches(text, task.query, false, maxMatchesPerFile);
+    int line = 1;
+    int lineStart = 0;
+    int scanned = 0;
+
+    foreach (const TextMatch &match, matches) {
+        for (; scanned < match.pos; ++scanned) {
+            if (text.at(scanned) == '\n') {
+                ++line;
+                lineStart = scanned + 1;
+            }
+        }
+        int lineEnd = text.indexOf('\n', match.pos);
+        if (lineEnd < 0) lineEnd = text.size();
+
+        TDriverFileSearchPanel::LineMatch lineMatch;
+        lineMatch.line = line;
+        lineMatch.column = match.pos - lineStart;
+        lineMatch.length = match.length;
+        lineMatch.text = text.mid(lineStart, qMin(lineEnd - lineStart, maxShownLineLength)).trimmed();
+        ret.matches << lineMatch;
+    }
+
+    return ret;
+}
+
+
+TDriverFileSearchPanel::TDriverFileSearchPanel(TDriverTabbedEditor *editor, QWidget *parent) :
+    QWidget(parent),
+    tabs(editor),
+    watcher(new QFutureWatcher<FileResult>(this)),
+    fileCount(0),
+    matchedFileCount(0),
+    matchCount(0)
+{
+    QSettings settings;
+    QGridLayout *layout = new QGridLayout(this);
+    layout->setObjectName("filesearch");
+
+    layout->addWidget(new QLabel(tr("Find:")), 0, 0);
+    searchText = new QLineEdit();
+    searchText->setObjectName("filesearch text");
+    layout->addWidget(searchText, 0, 1, 1, 2);
+
+    searchButton = new QPushButton(tr("&Search"));
+    searchButton->setObjectName("filesearch search");
+    layout->addWidget(searchButton, 0, 3);
+
+    layout->addWidget(new QLabel(tr("Replace with:")), 1, 0);
+    replaceText = new QLineEdit();
+    replaceText->setObjectName("filesearch replacetext");
+    layout->addWidget(replaceText, 1, 1, 1, 2);
+
+    replaceButton = new QPushButton(tr("Replace &All"));
+    replaceButton->setObjectName("filesearch replaceall");
+    layout->addWidget(replaceButton, 1, 3);
+
+    layout->addWidget(new QLabel(tr("In directory:")), 2, 0);
+    directory = new QLineEdit(settings.value("editor/searchdir", settings.value("editor/defaultdir")).toString());
+    directory->setObjectName("filesearch directory");
+    if (directory->text().isEmpty()) directory->setText(QDir::currentPath());
+    layout->addWidget(directory, 2, 1, 1, 2);
+
+    QPushButton *browseButton = new QPushButton(tr("&Browse..."));
+    browseButton->setObjectName("filesearch browse");
+    layout->addWidget(browseButton, 2, 3);
+
+    layout->addWidget(new QLabel(tr("File names:")), 3, 0);
+    filePatterns = new QLineEdit(settings.value("editor/searchpatterns", "*.rb *.feature").toString());
+    filePatterns->setObjectName("filesearch patterns");
+    layout->addWidget(filePatterns, 3, 1);
+
+    matchCase = new QCheckBox(tr("&Match case"));
+    matchCase->setObjectName("filesearch matchcase");
+    layout->addWidget(matchCase, 3, 2);
+
+    regExp = new QCheckBox(tr("Regular e&xpression"));
+    regExp->setObjectName("filesearch regexp");
+    layout->addWidget(regExp, 3, 3);
+
+    resultsView = new QTreeWidget();
+    resultsView->setObjectName("filesearch results");
+    resultsView->setUniformRowHeights(true);
+    resultsView->setColumnCount(2);
+    resultsView->setHeaderLabels(QStringList() << tr("File / Line") << tr("Text"));
+    resultsView->header()->setSectionResizeMode(QHeaderView::Interactive);
+    resultsView->header()->resizeSection(0, 250);
+    layout->addWidget(resultsView, 4, 0, 1, -1);
+
+    statusLabel = new QLabel();
+    statusLabel->setObjectName("filesearch status");
+    layout->addWidget(statusLabel, 5, 0, 1, -1);
+
+    connect(searchText, SIGNAL(returnPressed()), this, SLOT(startSearch()));
+    connect(searchButton, SIGNAL(clicked()), this, SLOT(startSearch()));
+    connect(replaceButton, SIGNAL(clicked()), this, SLOT(replaceAll()));
+    connect(browseButton, SIGNAL(clicked()), this, SLOT(browseDirectory()));
+    connect(watcher, SIGNAL(resultReadyAt(int)), this, SLOT(resultReady(int)));
+    connect(watcher, SIGNAL(finished()), this, SLOT(searchFinished()));
+    connect(resultsView, SIGNAL(itemActivated(QTreeWidgetItem*,int)), this, SLOT(emitActivated(QTreeWidgetItem*)));
+    connect(resultsView, SIGNAL(itemClicked(QTreeWidgetItem*,int)), this, SLOT(emitActivated(QTreeWidgetItem*)));
+}
+
+
+TDriverFileSearchPanel::~TDriverFileSearchPanel()
+{
+    watcher->cancel();
+    watcher->waitForFinished();
+}
+
+
+void TDriverFileSearchPanel::focusSearchText()
+{
+    searchText->setFocus();
+    searchText->selectAll();
+}
+
+
+TDriverFileSearchPanel::Query TDriverFileSearchPanel::currentQuery() const
+{
+    Query query;
+    query.text = searchText->text();
+    query.replaceText = replaceText->text();
+    query.matchCase = matchCase->isChecked();
+    query.regExp = regExp->isChecked();
+    return query;
+}
+
+
+TDriverCodeTextEdit *TDriverFileSearchPanel::openEditor(const QString &fileName) const
+{
+    for (int ind = 0; ind < tabs->count(); ++ind) {
+        TDriverCodeTextEdit *editor = qobject_cast<TDriverCodeTextEdit*>(tabs->widget(ind));
+        if (editor && editor->fileName() == fileName) return editor;
+    }
+    return NULL;
+}
+
+
+void TDriverFileSearchPanel::cancelSearch()
+{
+    if (watcher->isRunning()) {
+        watcher->cancel();
+        watcher->waitForFinished();
+        statusLabel->setText(tr("Search stopped, %1 matches in %2 files").arg(matchCount).arg(matchedFileCount));
+    }
+    // forget results of cancelled search
+    watcher->setFuture(QFuture<FileResult>());
+}
+
+
+void TDriverFileSearchPanel::startSearch()
+{
+    cancelSearch();
+    resultsView->clear();
+    fileCount = 0;
+    matchedFileCount = 0;
+    matchCount = 0;
+
+    const Query query = currentQuery();
+    if (query.text.isEmpty()) {
+        statusLabel->clear();
+        return;
+    }
+    if (query.regExp && !QRegExp(query.text, Qt::CaseSensitive, QRegExp::RegExp2).isValid()) {
+        statusLabel->setText(tr("Invalid regular expression"));
+        return;
+    }
+
+    QDir dir(directory->text());
+    if (directory->text().isEmpty() || !dir.exists()) {
+        statusLabel->setText(tr("Directory not found"));
+        return;
+    }
+    searchDir = dir.absolutePath();
+    resultsQuery = query;
+
+    QSettings settings;
+    settings.setValue("editor/searchdir", directory->text());
+    settings.setValue("editor/searchpatterns", filePatterns->text());
+
+    // open files are searched as shown in the editor, including unsaved changes
+    QHash<QString, QString> openTexts;
+    for (int ind = 0; ind < tabs->count(); ++ind) {
+        TDriverCodeTextEdit *editor = qobject_cast<TDriverCodeTextEdit*>(tabs->widget(ind));
+        if (editor && !editor->fileName().isEmpty()) openTexts.insert(editor->fileName(), editor->toPlainText());
+    }
+
+    QStringList patterns = filePatterns->text().split(QRegExp("[\\s,;]+"), QString::SkipEmptyParts);
+    if (patterns.isEmpty()) patterns << "*";
+
+    QList<FileTask> tasks;
+    QDirIterator it(searchDir, patterns, QDir::Files | QDir::Readable, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        FileTask task;
+        task.fileName = MEC::fileWithPath(it.next());
+        task.isOpen = openTexts.contains(task.fileName);
+        if (task.isOpen) task.openText = openTexts.value(task.fileName);
+        task.query = query;
+        tasks << task;
+    }
+    fileCount = tasks.size();
+
+    statusLabel->setText(tr("Searching %1 files...").arg(fileCount));
+    watcher->setFuture(QtConcurrent::mapped(tasks, searchFile));
+}
+
+
+void TDriverFileSearchPanel::resultReady(int index)
+{
+    const FileResult result = watcher->resultAt(index);
+    if (result.matches.isEmpty()) return;
+
+    QTreeWidgetItem *fileItem = new QTreeWidgetItem(QStringList()
+                                                    << QDir(searchDir).relativeFilePath(result.fileName)
+                                                    << tr("%1 matches").arg(result.matches.size()));
+    fileItem->setData(0, Qt::UserRole, result.fileName);
+    fileItem->setToolTip(0, result.fileName);
+
+    foreach (const LineMatch &match, result.matches) {
+        QTreeWidgetItem *item = new QTreeWidgetItem(fileItem, QStringList() << QString::number(match.line) << match.text);
+        item->setData(0, Qt::UserRole, result.fileName);
+        item->setData(0, Qt::UserRole+1, match.line);
+        item->setData(0, Qt::UserRole+2, match.column);
+        item->setData(0, Qt::UserRole+3, match.length);
+    }
+    resultsView->addTopLevelItem(fileItem);
+    fileItem->setExpanded(true);
+
+    ++matchedFileCount;
+    matchCount += result.matches.size();
+    statusLabel->setText(tr("Searching... %1 matches in %2 files").arg(matchCount).arg(matchedFileCount));
+}
+
+
+void TDriverFileSearchPanel::searchFinished()
+{
+    // cancelled and forgotten searches are reported by cancelSearch
+    if (watcher->isCanceled()) return;
+
+    statusLabel->setText(tr("%1 matches in %2 files, %3 files searched")
+                         .arg(matchCount).arg(matchedFileCount).arg(fileCount));
+}
+
+
+void TDriverFileSearchPanel::browseDirectory()
+{
+    QString dirName = QFileDialog::getExistingDirectory(this, tr("Search in Directory"), directory->text());
+    if (!dirName.isEmpty()) directory->setText(dirName);
+}
+
+
+void TDriverFileSearchPanel::emitActivated(QTreeWidgetItem *item)
+{
+    if (!item) return;
+    QString fileName = item->data(0, Qt::UserRole).toString();
+    int line = item->data(0, Qt::UserRole+1).toInt();
+    if (fileName.isEmpty()) return;
+    emit fileLineActivated(QString("%1:%2").arg(fileName).arg((line > 0) ? line : 1));
+
+    // file items have no match, and file may have changed since search
+    TDriverCodeTextEdit *editor = openEditor(fileName);
+    if (line <= 0 || !editor) return;
+    QTextBlock block = editor->document()->findBlockByNumber(line - 1);
+    const int column = item->data(0, Qt::UserRole+2).toInt();
+    const int length = item->data(0, Qt::UserRole+3).toInt();
+    if (!block.isValid() || column + length > block.length() - 1) return;
+
+    QTextCursor cur(block);
+    cur.setPosition(block.position() + column);
+    cur.setPosition(block.position() + column + length, QTextCursor::KeepAnchor);
+    editor->setTextCursor(cur);
+}
+
+
+void TDriverFileSearchPanel::replaceAll()
+{
+    // listed files were found with the query of the search, search text may have been edited since
+    Query query = resultsQuery;
+    query.replaceText = replaceText->text();
+    if (query.text.isEmpty() || resultsView->topLevelItemCount() == 0) return;
+
+    if (watcher->isRunning()) {
+        statusLabel->setText(tr("Search is still running, replace after it is done"));
+        return;
+    }
+
+    QStringList files;
+    int closedCount = 0;
+    for (int ind = 0; ind < resultsView->topLevelItemCount(); ++ind) {
+        files << resultsView->topLevelItem(ind)->data(0, Qt::UserRole).toString();
+        if (!openEditor(files.last())) ++closedCount;
+    }
+
+    QString question = tr("Replace all matches of '%1' with '%2' in %3 files?")
+            .arg(query.text, query.replaceText).arg(files.size());
+    if (closedCount > 0) {
+        question += "\n\n" + tr("%1 of the files are not open in editor, they are written directly and this can't be undone.")
+                .arg(closedCount);
+    }
+    if (QMessageBox::question(this, tr("Replace in Files"), question,
+                              QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes) {
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    int replaced = 0;
+    QStringList failed;
+    foreach (const QString &fileName, files) {
+        int count = 0;
+        if (replaceInFile(fileName, query, count)) replaced += count;
+        else failed << fileName;
+    }
+    QApplication::restoreOverrideCursor();
+
+    if (!failed.isEmpty()) {
+        QMessageBox::warning(this, tr("Replace in Files"),
+                             tr("Replacing failed in files:\n%1").arg(failed.join("\n")));
+    }
+
+    // list what is left after replacing
+    startSearch();
+    if (watcher->isRunning()) statusLabel->setText(tr("Replaced %1 matches, searching again...").arg(replaced));
+}
+
+
+bool TDriverFileSearchPanel::replaceInFile(const QString &fileName, const Query &query, int &count)
+{
+    count = 0;
+    TDriverCodeTextEdit *editor = openEditor(fileName);
+
+    if (editor) {
+        // single edit block, so the whole replace is one step in editor undo stack
+        QTextDocument *doc = editor->document();
+        const QList<TextMatch> matches = findMatches(doc->toPlainText(), query, true);
+        if (matches.isEmpty()) return true;
+
+        QTextCursor cur(doc);
+        cur.beginEditBlock();
+        for (int ii = matches.size() - 1; ii >= 0; --ii) {
+            cur.setPosition(matches.at(ii).pos);
+            cur.setPosition(matches.at(ii).pos + matches.at(ii).length, QTextCursor::KeepAnchor);
+            cur.insertText(matches.at(ii).replacement);
+        }
+        cur.endEditBlock();
+        count = matches.size();
+        return true;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly)) return false;
+    const QByteArray bytes = file.readAll();
+    file.close();
+
+    QTextCodec *codec;
+    bool haveBom;
+    QString text = decodeText(bytes, codec, haveBom);
+    // don't touch files which would not be written back unchanged
+    if (encodeText(text, codec, haveBom) != bytes) return false;
+
+    const QList<TextMatch> matches = findMatches(text, query, true);
+    if (matches.isEmpty()) return true;
+
+    for (int ii = matches.size() - 1; ii >= 0; --ii) {
+        text.replace(matches.at(ii).pos, matches.at(ii).length, matches.at(ii).replacement);
+    }
+
+    // original file is kept if writing fails
+    QSaveFile outFile(fileName);
+    if (!outFile.open(QFile::WriteOnly)) return false;
+    if (outFile.write(encodeText(text, codec, haveBom)) < 0) {
+        outFile.cancelWriting();
+    }
+    if (!outFile.commit()) return false;
+    count = matches.size();
+    return true;
+}
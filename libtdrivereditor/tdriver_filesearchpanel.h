@@ -0,0 +1,122 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#ifndef TDRIVER_FILESEARCHPANEL_H
+#define TDRIVER_FILESEARCHPANEL_H
+
+#include "libtdrivereditor_global.h"
+
+#include <QWidget>
+#include <QFutureWatcher>
+#include <QList>
+#include <QString>
+
+class QCheckBox;
+class QLabel;
+class QLineEdit;
+class QPushButton;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+class TDriverTabbedEditor;
+class TDriverCodeTextEdit;
+
+// Searches all files under a directory, files are read and matched in worker threads and
+// results are listed as each file is done. Files open in editor tabs are searched and replaced
+// in their editor instead of on disk, so replacing can be undone there.
+class LIBTDRIVEREDITORSHARED_EXPORT TDriverFileSearchPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    struct Query {
+        QString text;
+        QString replaceText;
+        bool matchCase;
+        bool regExp;
+        Query() : matchCase(false), regExp(false) {}
+    };
+
+    struct LineMatch {
+        int line;
+        int column;
+        int length;
+        QString text;
+    };
+
+    struct FileResult {
+        QString fileName;
+        QList<LineMatch> matches;
+    };
+
+    struct FileTask {
+        QString fileName;
+        QString openText; // contents of editor, if file is open
+        bool isOpen;
+        Query query;
+    };
+
+    explicit TDriverFileSearchPanel(TDriverTabbedEditor *editor, QWidget *parent = 0);
+    ~TDriverFileSearchPanel();
+
+signals:
+    // file:line spec accepted by TDriverTabbedEditor::gotoLine
+    void fileLineActivated(QString fileLineSpec);
+
+public slots:
+    void focusSearchText();
+    void startSearch();
+    void cancelSearch();
+    void replaceAll();
+
+private slots:
+    void resultReady(int index);
+    void searchFinished();
+    void browseDirectory();
+    void emitActivated(QTreeWidgetItem *item);
+
+private:
+    Query currentQuery() const;
+    TDriverCodeTextEdit *openEditor(const QString &fileName) const;
+    bool replaceInFile(const QString &fileName, const Query &query, int &count);
+
+    TDriverTabbedEditor *tabs;
+
+    QLineEdit *searchText;
+    QLineEdit *replaceText;
+    QLineEdit *directory;
+    QLineEdit *filePatterns;
+    QCheckBox *matchCase;
+    QCheckBox *regExp;
+    QPushButton *searchButton;
+    QPushButton *replaceButton;
+    QTreeWidget *resultsView;
+    QLabel *statusLabel;
+
+    QFutureWatcher<FileResult> *watcher;
+    Query resultsQuery; // query which produced resultsView contents
+    QString searchDir;
+    int fileCount;
+    int matchedFileCount;
+    int matchCount;
+};
+
+#endif // TDRIVER_FILESEARCHPANEL_H
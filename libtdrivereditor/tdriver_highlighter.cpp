@@ -26,6 +26,10 @@
 #include <QFont>
 #include <QStringList>
 #include <QFile>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTimer>
+#include <QElapsedTimer>
 
 #include "tdriver_editor_common.h"
 
@@ -38,8 +42,14 @@ TDriverHighlighter::TDriverHighlighter(QTextDocument *parent) :
         keywordFormat(new QTextCharFormat),
         singleQuotationFormat(new QTextCharFormat),
         doubleQuotationFormat(new QTextCharFormat),
-        ruleListList()
+        ruleListList(),
+        priorityFirst(0),
+        priorityLast(-1),
+        chunkTimer(new QTimer(this))
 {
+    chunkTimer->setSingleShot(true);
+    chunkTimer->setInterval(0);
+    connect(chunkTimer, SIGNAL(timeout()), this, SLOT(highlightNextChunk()));
 
     // setup formats
     // this is used to detect if a given char is formatted with defaultFormat or not
@@ -96,20 +106,97 @@ int TDriverHighlighter::readPlainStrings(
         return -1;
     }
 
+    HighlightingWordRule *wordRule = NULL;
+    if (!rules.isEmpty() && rules.last()->type() == 3) {
+        // non-const pointer to the same rule
+        wordRule = static_cast<HighlightingWordRule*>(stateRulePtrs.value(rules.last()->stateIndex));
+    }
+    else {
+        wordRule = new HighlightingWordRule(this);
+        rules.append(wordRule);
+    }
+
     int count = 0;
     foreach (QString word, keywords) {
-        HighlightingRule1 *rule1 = new HighlightingRule1(this);
-        rule1->matchPat = new QRegExp(word.trimmed().prepend("\\b").append("\\b"));
-        rule1->format = format;
-        rules.append(rule1);
+        wordRule->addWord(word.trimmed(), format);
         ++count;
     }
     return count;
 }
 
 
+// milliseconds of highlighting done per event loop round by highlightNextChunk
+static const int incrementalChunkTime = 10;
+
+
+void TDriverHighlighter::highlightIncrementally(QTextDocument *doc, int firstPriority, int lastPriority)
+{
+    pending = (doc) ? QTextCursor(doc) : QTextCursor();
+    priorityFirst = firstPriority;
+    priorityLast = lastPriority;
+
+    // full pass done by QSyntaxHighlighter only highlights priority blocks now
+    if (doc != document()) setDocument(doc);
+    else rehighlight();
+
+    if (document()) chunkTimer->start();
+    else pending = QTextCursor();
+}
+
+
+void TDriverHighlighter::setPriorityBlocks(int first, int last)
+{
+    if (first == priorityFirst && last == priorityLast) return;
+
+    priorityFirst = first;
+    priorityLast = last;
+    if (pending.isNull() || !document()) return;
+
+    for (QTextBlock block = document()->findBlockByNumber(qMax(first, pendingFrom()));
+         block.isValid() && block.blockNumber() <= last;
+         block = block.next()) {
+        if (block.userState() == DeferredBlockState) rehighlightBlock(block);
+    }
+}
+
+
+void TDriverHighlighter::highlightNextChunk()
+{
+    if (pending.isNull() || !document()) return;
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    QTextBlock block = pending.block();
+    while (block.isValid() && elapsed.elapsed() < incrementalChunkTime) {
+        // block must be allowed before it is highlighted,
+        // following deferred block then stops the state propagation
+        const QTextBlock next = block.next();
+        if (next.isValid()) pending.setPosition(next.position());
+        else pending = QTextCursor();
+        rehighlightBlock(block);
+        block = next;
+    }
+
+    if (block.isValid()) chunkTimer->start();
+}
+
+
+bool TDriverHighlighter::isDeferred(int blockNumber) const
+{
+    const int from = pendingFrom();
+    return from >= 0 && blockNumber >= from
+            && (blockNumber < priorityFirst || blockNumber > priorityLast);
+}
+
+
 void TDriverHighlighter::highlightBlock(const QString &text)
 {
+    if (isDeferred(currentBlock().blockNumber())) {
+        setCurrentBlockState(DeferredBlockState);
+        return;
+    }
+
     int startIndex = 0;
     if (previousBlockState() >= 0) {
         const HighlightingRuleBase *rule = stateRulePtrs.value(previousBlockState());
@@ -141,14 +228,13 @@ void TDriverHighlighter::highlightBlock(const QString &text)
             int index = startIndex;
 
             forever {
-                index = rule->matchPat->indexIn(text, index, rule->matchCaretMode);
+                // this length value applies if rule coveres all of text to be highlighted
+                int length = 0;
+                index = rule->matchIn(text, index, length);
 
                 // break if no match
                 if (index == -1) break; // continue inner foreach to next rule
 
-                // this length value applies if rule coveres all of text to be highlighted
-                int length = rule->matchPat->matchedLength();
-
                 //qDebug() << FFL << index << length;
 
                 // skip this match if position already formatted
@@ -194,6 +280,14 @@ TDriverHighlighter::HighlightingRuleBase::HighlightingRuleBase(TDriverHighlighte
     castowner->stateRulePtrs.append(this);
 }
 
+int TDriverHighlighter::HighlightingRuleBase::matchIn(const QString &text, int from, int &length) const
+{
+    int index = matchPat->indexIn(text, from, matchCaretMode);
+    length = matchPat->matchedLength();
+    return index;
+}
+
+
 void TDriverHighlighter::HighlightingRuleBase::postMatch (
         const QString &,
         int &startInd,
@@ -270,3 +364,84 @@ void TDriverHighlighter::HighlightingRule2::postMatch (
 
     castowner->setFormat(startInd, formatLen, *format);
 }
+
+
+//
+// member functions of HighlightingWordRule
+
+TDriverHighlighter::HighlightingWordRule::HighlightingWordRule(TDriverHighlighter *owner_)  :
+        HighlightingRuleBase(owner_),
+        minLength(0),
+        maxLength(0),
+        matchedFormat(NULL)
+{
+}
+
+
+void TDriverHighlighter::HighlightingWordRule::addWord(const QString &word, const QTextCharFormat *wordFormat)
+{
+    if (word.isEmpty() || words.contains(word)) return;
+
+    if (words.isEmpty() || word.length() < minLength) minLength = word.length();
+    if (word.length() > maxLength) maxLength = word.length();
+    words.insert(word, wordFormat);
+}
+
+
+static inline bool isWordChar(const QChar &ch)
+{
+    return ch.isLetterOrNumber() || ch == QChar('_');
+}
+
+
+int TDriverHighlighter::HighlightingWordRule::matchIn(const QString &text, int from, int &length) const
+{
+    const QChar *data = text.constData();
+    const int textLength = text.length();
+    int pos = from;
+
+    // don't start from the middle of a word
+    if (pos > 0) {
+        while (pos < textLength && isWordChar(data[pos]) && isWordChar(data[pos-1])) ++pos;
+    }
+
+    while (pos < textLength) {
+        if (!isWordChar(data[pos])) {
+            ++pos;
+            continue;
+        }
+
+        int end = pos + 1;
+        while (end < textLength && isWordChar(data[end])) ++end;
+
+        // words like defined? include the trailing ? or !
+        int len = end - pos;
+        if (end < textLength && (data[end] == QChar('?') || data[end] == QChar('!'))) ++len;
+
+        for (; len >= end - pos; --len) {
+            if (len < minLength || len > maxLength) continue;
+
+            // raw data wrapper avoids copying text for lookup
+            const QTextCharFormat *wordFormat = words.value(QString::fromRawData(data + pos, len));
+            if (wordFormat) {
+                matchedFormat = wordFormat;
+                length = len;
+                return pos;
+            }
+        }
+        pos = end;
+    }
+
+    length = 0;
+    return -1;
+}
+
+
+void TDriverHighlighter::HighlightingWordRule::postMatch (
+        const QString &,
+        int &startInd,
+        int &formatLen ) const
+{
+    TDriverHighlighter *castowner = const_cast<TDriverHighlighter *>(owner);
+    castowner->setFormat(startInd, formatLen, *matchedFormat);
+}
@@ -24,11 +24,14 @@
 #include "libtdrivereditor_global.h"
 
 #include <QSyntaxHighlighter>
+#include <QTextCursor>
 
 class QString;
 class QTextCharFormat;
+class QTimer;
 
 #include <QList>
+#include <QHash>
 
 class LIBTDRIVEREDITORSHARED_EXPORT TDriverHighlighter : public QSyntaxHighlighter
 {
@@ -55,6 +58,9 @@ protected:
             qWarning("TDriverHighlighter::HighlightingRuleBase::handlePreviousState called!");
             return 0;
         }
+        // matchIn: returns index of next match starting from index from, or -1,
+        // and sets length to length of the match
+        virtual int matchIn(const QString &text, int from, int &length) const;
         // postMatch: called when rule matched
         // returns new currentBlockState >= -1, or -2 for no change in state
         virtual void postMatch(const QString &text, int &startInd, int &formatLen) const;
@@ -88,13 +94,48 @@ protected:
     };
 
 
+    // Class for whole word entries: all words of a rule list are looked up from
+    // one hash while text is scanned once, instead of having a regexp per word
+    class HighlightingWordRule: public HighlightingRuleBase
+    {
+    public:
+        virtual int type() const { return 3; };
+        // first added format of a word is used
+        void addWord(const QString &word, const QTextCharFormat *wordFormat);
+        // matchIn: overloaded
+        virtual int matchIn(const QString &text, int from, int &length) const;
+        // postMatch: overloaded
+        virtual void postMatch(const QString &text, int &startInd, int &formatLen) const;
+        HighlightingWordRule(TDriverHighlighter *owner);
+
+    private:
+        QHash<QString, const QTextCharFormat*> words;
+        int minLength;
+        int maxLength;
+        // set when matchIn finds a word, used by following postMatch
+        mutable const QTextCharFormat *matchedFormat;
+    };
+
+
 public:
     explicit TDriverHighlighter(QTextDocument *parent=NULL);
 
-    // returns -1 for file error, -2 for parse error, >=0 for number of rules added
+    // Attaches highlighter to doc and highlights it incrementally: blocks from
+    // firstPriority to lastPriority (the visible ones) first, the rest in chunks
+    // when event loop is idle. Edits are handled by QSyntaxHighlighter, which
+    // re-runs highlightBlock from the changed block until block state converges.
+    void highlightIncrementally(QTextDocument *doc, int firstPriority, int lastPriority);
+    void setPriorityBlocks(int first, int last);
+    bool isIncrementalPending() const { return !pending.isNull(); }
+
+    // words are added to word rule at the end of rules, or to a new word rule
+    // returns -1 for file error, -2 for parse error, >=0 for number of words added
     int readPlainStrings(const QString &file, const QTextCharFormat *format,
                             QList<const HighlightingRuleBase*> &rules);
 
+private slots:
+    void highlightNextChunk();
+
 protected:
     virtual void highlightBlock(const QString &);
 
@@ -109,6 +150,19 @@ protected:
 
     QList<HighlightingRuleBase*> stateRulePtrs;
     QList< QList<const HighlightingRuleBase*> > ruleListList;
+
+private:
+    // block state of blocks not yet reached by incremental highlighting
+    enum { DeferredBlockState = -2 };
+    bool isDeferred(int blockNumber) const;
+    int pendingFrom() const { return pending.isNull() ? -1 : pending.block().blockNumber(); }
+
+    // positioned in first block not highlighted by incremental pass, null when done,
+    // cursor follows edits above it unlike a stored block number would
+    QTextCursor pending;
+    int priorityFirst;
+    int priorityLast;
+    QTimer *chunkTimer;
 };
 
 #endif // TDRIVER_HIGHLIGHTER_H
@@ -0,0 +1,286 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#include "tdriver_largefileview.h"
+
+#include <QFileSystemWatcher>
+#include <QKeyEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QTextCodec>
+#include <QTimer>
+
+#include <string.h>
+
+#include <tdriver_debug_macros.h>
+
+
+// longer lines are shown truncated, to keep painting cheap
+static const int maxLineBytes = 4096;
+
+// end of previously indexed data which must be unchanged for file to be treated as appended
+static const int appendCheckBytes = 4096;
+
+
+TDriverLargeFileView::TDriverLargeFileView(QWidget *parent) :
+    QAbstractScrollArea(parent),
+    data(NULL),
+    dataSize(0),
+    longestLine(0),
+    fcodec(NULL),
+    watcher(new QFileSystemWatcher(this)),
+    reloadTimer(new QTimer(this))
+{
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setBackgroundRole(QPalette::Base);
+
+    // a growing log file reports changes continuously, reload at most this often
+    reloadTimer->setSingleShot(true);
+    reloadTimer->setInterval(500);
+    connect(reloadTimer, SIGNAL(timeout()), SLOT(reloadFile()));
+    connect(watcher, SIGNAL(fileChanged(QString)), reloadTimer, SLOT(start()));
+}
+
+
+TDriverLargeFileView::~TDriverLargeFileView()
+{
+    closeFile();
+}
+
+
+void TDriverLargeFileView::closeFile()
+{
+    if (data) file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(data)));
+    data = NULL;
+    dataSize = 0;
+    file.close();
+    lineStarts.clear();
+    longestLine = 0;
+}
+
+
+// opens and maps fname, leaving line index empty
+bool TDriverLargeFileView::mapFile()
+{
+    errString.clear();
+    file.setFileName(fname);
+
+    if (!file.open(QFile::ReadOnly)) {
+        errString = file.errorString();
+        return false;
+    }
+
+    dataSize = file.size();
+    if (dataSize > 0) {
+        data = reinterpret_cast<const char*>(file.map(0, dataSize));
+        if (!data) {
+            errString = file.errorString();
+            closeFile();
+            return false;
+        }
+    }
+
+    QTextCodec *utfCodec = QTextCodec::codecForUtfText(QByteArray::fromRawData(data, qMin(dataSize, qint64(4))), NULL);
+    if (utfCodec && utfCodec->mibIndex() != 106) {
+        // line breaks of UTF-16 and UTF-32 are not single bytes
+        errString = tr("Encoding %1 is not supported by viewer").arg(QString::fromLatin1(utfCodec->name()));
+        closeFile();
+        return false;
+    }
+    return true;
+}
+
+
+// indexes line starts after the last indexed one, which is the start of a possibly incomplete line
+void TDriverLargeFileView::indexLines()
+{
+    if (lineStarts.isEmpty()) lineStarts.append(0);
+
+    const char *pos = data + lineStarts.last();
+    const char *end = data + dataSize;
+    while (pos < end) {
+        const char *lf = static_cast<const char*>(memchr(pos, '\n', end - pos));
+        const char *next = (lf) ? lf + 1 : end;
+        longestLine = qMax(longestLine, qint64(next - pos));
+        if (lf && next < end) lineStarts.append(next - data);
+        pos = next;
+    }
+}
+
+
+bool TDriverLargeFileView::openFile(const QString &fileName)
+{
+    closeFile();
+    if (!watcher->files().isEmpty()) watcher->removePaths(watcher->files());
+
+    fname = fileName;
+    if (!mapFile()) return false;
+
+    // decide between UTF-8 and locale encoding from beginning of file
+    fcodec = QTextCodec::codecForName("UTF-8");
+    QTextCodec::ConverterState state;
+    fcodec->toUnicode(data, int(qMin(dataSize, qint64(64*1024))), &state);
+    if (state.invalidChars > 0) fcodec = QTextCodec::codecForLocale();
+
+    indexLines();
+
+    qDebug() << FCFL << fileName << "size" << dataSize << "lines" << lineStarts.size();
+    watcher->addPath(fileName);
+    updateScrollBars();
+    viewport()->update();
+    return true;
+}
+
+
+void TDriverLargeFileView::reloadFile()
+{
+    // file may have been replaced or truncated, so it is always mapped again,
+    // but if old content is still there, only the appended tail is indexed
+    const int topLine = verticalScrollBar()->value();
+    const qint64 oldSize = dataSize;
+    const int checkSize = int(qMin(oldSize, qint64(appendCheckBytes)));
+    const QByteArray oldTail = (data && file.size() >= oldSize)
+            ? QByteArray(data + oldSize - checkSize, checkSize) : QByteArray();
+    QVector<qint64> oldLineStarts;
+    oldLineStarts.swap(lineStarts);
+    const qint64 oldLongestLine = longestLine;
+
+    closeFile();
+    if (!mapFile()) {
+        qWarning() << FCFL << "reopen failed:" << errString;
+        updateScrollBars();
+        viewport()->update();
+        return;
+    }
+
+    if (checkSize > 0 && oldTail.size() == checkSize && dataSize >= oldSize
+            && memcmp(data + oldSize - checkSize, oldTail.constData(), checkSize) == 0) {
+        lineStarts.swap(oldLineStarts);
+        longestLine = oldLongestLine;
+    }
+    indexLines();
+
+    // file replaced by rename is a new file for the watcher
+    if (!watcher->files().contains(fname)) watcher->addPath(fname);
+
+    updateScrollBars();
+    verticalScrollBar()->setValue(topLine);
+    viewport()->update();
+}
+
+
+void TDriverLargeFileView::gotoLine(int lineNum)
+{
+    // lineNum starts from 1, centered to view
+    int visibleLines = viewport()->height() / fontMetrics().lineSpacing();
+    verticalScrollBar()->setValue(lineNum - 1 - visibleLines / 2);
+}
+
+
+int TDriverLargeFileView::gutterWidth() const
+{
+    return fontMetrics().width(QLatin1Char('0')) * QString::number(lineStarts.size()).size() + 8;
+}
+
+
+QString TDriverLargeFileView::lineText(int line) const
+{
+    qint64 start = lineStarts.at(line);
+    qint64 end = (line + 1 < lineStarts.size()) ? lineStarts.at(line + 1) : dataSize;
+
+    if (end > start && data[end-1] == '\n') --end;
+    if (end > start && data[end-1] == '\r') --end;
+    int len = int(qMin(end - start, qint64(maxLineBytes)));
+
+    return fcodec->toUnicode(data + start, len);
+}
+
+
+void TDriverLargeFileView::updateScrollBars()
+{
+    int lineHeight = fontMetrics().lineSpacing();
+    int visibleLines = viewport()->height() / lineHeight;
+
+    verticalScrollBar()->setRange(0, qMax(0, lineStarts.size() - visibleLines));
+    verticalScrollBar()->setPageStep(visibleLines);
+
+    int charWidth = fontMetrics().width(QLatin1Char('x'));
+    int textWidth = int(qMin(longestLine, qint64(maxLineBytes))) * charWidth;
+    int visibleWidth = viewport()->width() - gutterWidth();
+    horizontalScrollBar()->setRange(0, qMax(0, textWidth - visibleWidth));
+    horizontalScrollBar()->setPageStep(visibleWidth);
+    horizontalScrollBar()->setSingleStep(charWidth);
+}
+
+
+void TDriverLargeFileView::paintEvent(QPaintEvent *)
+{
+    // reading mapping beyond end of truncated file would crash, so drop it until reload
+    if (data && file.size() < dataSize) {
+        closeFile();
+        reloadTimer->start();
+        updateScrollBars();
+    }
+
+    QPainter painter(viewport());
+    int lineHeight = fontMetrics().lineSpacing();
+    int gutter = gutterWidth();
+    int width = viewport()->width();
+
+    painter.fillRect(0, 0, gutter, viewport()->height(), palette().window());
+
+    int firstLine = verticalScrollBar()->value();
+    int lastLine = qMin(lineStarts.size(), firstLine + viewport()->height() / lineHeight + 1);
+    int xOffset = horizontalScrollBar()->value();
+
+    for (int line = firstLine, y = 0; line < lastLine; ++line, y += lineHeight) {
+        painter.setClipping(false);
+        painter.setPen(palette().color(QPalette::Dark));
+        painter.drawText(QRect(0, y, gutter - 4, lineHeight),
+                         Qt::AlignRight | Qt::AlignVCenter, QString::number(line + 1));
+
+        painter.setClipRect(gutter, y, width - gutter, lineHeight);
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(QRect(gutter + 4 - xOffset, y, width + xOffset, lineHeight),
+                         Qt::AlignLeft | Qt::AlignVCenter | Qt::TextSingleLine | Qt::TextExpandTabs,
+                         lineText(line));
+    }
+}
+
+
+void TDriverLargeFileView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+
+void TDriverLargeFileView::keyPressEvent(QKeyEvent *event)
+{
+    if (event->matches(QKeySequence::MoveToStartOfDocument)) {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderToMinimum);
+    }
+    else if (event->matches(QKeySequence::MoveToEndOfDocument)) {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderToMaximum);
+    }
+    else {
+        QAbstractScrollArea::keyPressEvent(event);
+    }
+}
@@ -0,0 +1,83 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#ifndef TDRIVER_LARGEFILEVIEW_H
+#define TDRIVER_LARGEFILEVIEW_H
+
+#include "libtdrivereditor_global.h"
+
+#include <QAbstractScrollArea>
+#include <QFile>
+#include <QVector>
+
+class QTextCodec;
+class QFileSystemWatcher;
+class QTimer;
+
+
+// Read-only view of a memory mapped file, for files too large for TDriverCodeTextEdit.
+// Only line start offsets are kept in memory, visible lines are decoded when painted.
+// Supports 8-bit and UTF-8 encodings. When file grows, only appended part is indexed.
+class LIBTDRIVEREDITORSHARED_EXPORT TDriverLargeFileView : public QAbstractScrollArea
+{
+    Q_OBJECT
+public:
+    explicit TDriverLargeFileView(QWidget *parent = 0);
+    ~TDriverLargeFileView();
+
+    bool openFile(const QString &fileName);
+    const QString &fileName() const { return fname; }
+    const QString &errorString() const { return errString; }
+    QTextCodec *fileCodec() const { return fcodec; }
+    int lineCount() const { return lineStarts.size(); }
+
+public slots:
+    void gotoLine(int lineNum);
+
+protected:
+    virtual void paintEvent(QPaintEvent *);
+    virtual void resizeEvent(QResizeEvent *);
+    virtual void keyPressEvent(QKeyEvent *);
+
+private slots:
+    void reloadFile();
+
+private:
+    bool mapFile();
+    void indexLines();
+    void closeFile();
+    void updateScrollBars();
+    int gutterWidth() const;
+    QString lineText(int line) const;
+
+    QFile file;
+    const char *data;
+    qint64 dataSize;
+    QVector<qint64> lineStarts;
+    qint64 longestLine;
+
+    QString fname;
+    QString errString;
+    QTextCodec *fcodec;
+    QFileSystemWatcher *watcher;
+    QTimer *reloadTimer;
+};
+
+#endif // TDRIVER_LARGEFILEVIEW_H
@@ -42,6 +42,7 @@ TDriverRubyInteract::TDriverRubyInteract(QWidget *parent) :
   , stdoutFormat(new QTextCharFormat)
   , stderrFormat(new QTextCharFormat)
   , prevSeqNum(0)
+  , evalGeneration(0)
 {
     stdoutFormat->setForeground(QBrush(Qt::darkGray));
     stdoutFormat->setFontFixedPitch(true);
@@ -72,6 +73,10 @@ TDriverRubyInteract::TDriverRubyInteract(QWidget *parent) :
 
 void TDriverRubyInteract::resetQueryQueue()
 {
+    // ruby instance is gone or reseted, objects of cached completions with it
+    complCache.clear();
+    ++evalGeneration;
+
     while ( !queryQueue.empty() ) {
         QueryQueueItem query = queryQueue.takeFirst();
 
@@ -218,12 +223,18 @@ bool TDriverRubyInteract::sendNextQuery()
 
 bool TDriverRubyInteract::queryCompletions(QByteArray statement)
 {
+    if (complCache.contains(statement)) {
+        emit completionResult(sender(), statement.trimmed(), complCache.completions(statement));
+        return true;
+    }
+
     struct QueryQueueItem query;
     query.type = QueryQueueItem::COMPLETION,
     query.client = sender(),
     query.rbiSeqNum = 0;
     query.command = "line_completion",
     query.statement = statement.trimmed();
+    query.evalGeneration = evalGeneration;
 
     queryQueue.append(query);
     return sendNextQuery();
@@ -238,6 +249,7 @@ bool TDriverRubyInteract::evalStatement(QByteArray statement)
     query.rbiSeqNum = 0;
     query.command = "line_execution",
     query.statement = statement.trimmed();
+    query.evalGeneration = evalGeneration;
 
     queryQueue.append(query);
     return sendNextQuery();
@@ -269,11 +281,18 @@ void TDriverRubyInteract::rbiMessage(quint32 seqNum, QByteArray name, BAListMap
                     }
                 }
                 //qDebug() << FCFL << completionLines;
+                // completions queued before an evaluation completed may describe changed objects
+                if (query.evalGeneration == evalGeneration) {
+                    complCache.insert(query.statement, completionLines);
+                }
                 emit completionResult(query.client, query.statement, completionLines);
             }
             break;
 
         case QueryQueueItem::EVALUATION:
+            // evaluation may have changed any object, so their completions can't be trusted any more
+            complCache.clear();
+            ++evalGeneration;
             //qDebug() << FCFL << "EVALUATION RESULT" << message;
             //emit evaluationResult(query.client, query.statement, resultLines); // sent by rbiStdoutText/rbiStderrText
             emit evaluationResult(query.client, query.statement, QStringList()); // sent by rbiStdoutText/rbiStderrText
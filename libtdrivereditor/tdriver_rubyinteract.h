@@ -27,6 +27,7 @@
 #include <QList>
 
 #include "tdriver_runconsole.h"
+#include "tdriver_completioncache.h"
 
 #include <tdriver_rubyinterface.h>
 
@@ -39,6 +40,8 @@ Q_OBJECT
 public:
     explicit TDriverRubyInteract(QWidget *parent = 0);
 
+    const TDriverCompletionCache *completionCache() const { return &complCache; }
+
 
 signals:
     void completionResult(QObject *client, QByteArray statement, QStringList result);
@@ -76,6 +79,7 @@ protected:
         quint32 rbiSeqNum;
         QByteArray command;
         QByteArray statement;
+        quint32 evalGeneration; // evalGeneration when queued
     };
 
     QList<struct QueryQueueItem> queryQueue;
@@ -89,6 +93,8 @@ private:
     QTextCharFormat *stderrFormat;
 
     quint32 prevSeqNum; // used for accepting STDOUT/STDERR text coming after message text
+    TDriverCompletionCache complCache;
+    quint32 evalGeneration; // incremented when evaluation completes, invalidating cached completions
 };
 
 #endif // TDRIVER_RUBYINTERACT_H
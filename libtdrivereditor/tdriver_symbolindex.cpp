@@ -0,0 +1,527 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#include "tdriver_symbolindex.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QRegExp>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QTimer>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+
+#include <tdriver_debug_macros.h>
+
+static const quint32 indexMagic = 0x54445349; // "TDSI"
+static const quint32 indexFormatVersion = 2;
+
+static const int maxIndexedFiles = 20000;
+// inotify watches are a limited resource, beyond this changes are noticed at next startup
+static const int maxWatchedFiles = 4000;
+static const int maxWatchedDirs = 1000;
+
+// projects not opened for this long, or beyond this count, are dropped from index
+static const qint64 maxRootAgeMSecs = qint64(30) * 24 * 60 * 60 * 1000;
+static const int maxRoots = 20;
+
+
+static QDataStream &operator<<(QDataStream &out, const TDriverSymbolIndex::Symbol &symbol)
+{
+    return out << symbol.name << symbol.line << symbol.kind;
+}
+
+
+static QDataStream &operator>>(QDataStream &in, TDriverSymbolIndex::Symbol &symbol)
+{
+    return in >> symbol.name >> symbol.line >> symbol.kind;
+}
+
+
+static QDataStream &operator<<(QDataStream &out, const TDriverSymbolIndex::FileEntry &entry)
+{
+    return out << entry.modified << entry.size << entry.symbols;
+}
+
+
+static QDataStream &operator>>(QDataStream &in, TDriverSymbolIndex::FileEntry &entry)
+{
+    return in >> entry.modified >> entry.size >> entry.symbols;
+}
+
+
+TDriverSymbolIndex::TDriverSymbolIndex(QObject *parent) :
+    QObject(parent),
+    updateTimer(new QTimer(this)),
+    saveTimer(new QTimer(this)),
+    scanWatcher(new QFutureWatcher<ScanResult>(this)),
+    fsWatcher(new QFileSystemWatcher(this))
+{
+    // changes often come in bursts, eg. when several files are saved
+    updateTimer->setSingleShot(true);
+    updateTimer->setInterval(500);
+    saveTimer->setSingleShot(true);
+    saveTimer->setInterval(5000);
+
+    connect(updateTimer, SIGNAL(timeout()), this, SLOT(startUpdate()));
+    connect(saveTimer, SIGNAL(timeout()), this, SLOT(save()));
+    connect(scanWatcher, SIGNAL(finished()), this, SLOT(updateFinished()));
+    connect(fsWatcher, SIGNAL(fileChanged(QString)), this, SLOT(fileChanged(QString)));
+    connect(fsWatcher, SIGNAL(directoryChanged(QString)), this, SLOT(directoryChanged(QString)));
+
+    load();
+    pruneRoots();
+    rebuildLookup();
+
+    // find files changed since last session
+    pendingDirs = roots.keys();
+    if (!pendingDirs.isEmpty()) updateTimer->start();
+}
+
+
+TDriverSymbolIndex::~TDriverSymbolIndex()
+{
+    // running scan has its own copies of data, it is not waited for
+    if (saveTimer->isActive()) save();
+}
+
+
+QString TDriverSymbolIndex::cacheFileName()
+{
+    QString dirPath(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    if (dirPath.isEmpty()) return QString();
+    return dirPath + "/symbolindex.cache";
+}
+
+
+bool TDriverSymbolIndex::load()
+{
+    const QString fileName(cacheFileName());
+    QFile file(fileName);
+    if (fileName.isEmpty() || !file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 formatVersion = 0;
+    in >> magic >> formatVersion;
+
+    if (magic != indexMagic || formatVersion != indexFormatVersion) {
+        qDebug() << FCFL << "ignoring incompatible index file" << fileName;
+        return false;
+    }
+    in.setVersion(QDataStream::Qt_5_0);
+
+    QHash<QString, qint64> readRoots;
+    QHash<QString, FileEntry> readEntries;
+    in >> readRoots >> readEntries;
+
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << FCFL << "corrupted index file" << fileName;
+        return false;
+    }
+
+    roots.swap(readRoots);
+    entries.swap(readEntries);
+    qDebug() << FCFL << "read" << entries.size() << "files from" << fileName;
+    return true;
+}
+
+
+bool TDriverSymbolIndex::save()
+{
+    saveTimer->stop();
+    const QString fileName(cacheFileName());
+    if (fileName.isEmpty()) return false;
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    // old index is replaced only after new one is completely written
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << FCFL << "failed to open" << fileName;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out << indexMagic << indexFormatVersion;
+    out.setVersion(QDataStream::Qt_5_0);
+    out << roots << entries;
+
+    if (out.status() != QDataStream::Ok) file.cancelWriting();
+    if (!file.commit()) {
+        qDebug() << FCFL << "failed to write" << fileName << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+
+// drops removed and long unopened projects, and files not in remaining projects
+void TDriverSymbolIndex::pruneRoots()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QList<qint64> opened;
+
+    QHash<QString, qint64>::iterator it = roots.begin();
+    while (it != roots.end()) {
+        if (now - it.value() > maxRootAgeMSecs || !QFileInfo(it.key()).isDir()) {
+            it = roots.erase(it);
+        }
+        else {
+            opened << it.value();
+            ++it;
+        }
+    }
+
+    if (roots.size() > maxRoots) {
+        std::sort(opened.begin(), opened.end());
+        const qint64 oldestKept = opened.at(opened.size() - maxRoots);
+        it = roots.begin();
+        while (it != roots.end()) {
+            if (it.value() < oldestKept) it = roots.erase(it);
+            else ++it;
+        }
+    }
+
+    QHash<QString, FileEntry>::iterator entryIt = entries.begin();
+    while (entryIt != entries.end()) {
+        if (rootOf(entryIt.key()).isNull()) entryIt = entries.erase(entryIt);
+        else ++entryIt;
+    }
+}
+
+
+// nearest directory with project marker, never home, temp or file system root,
+// or null string if file is not in a project
+QString TDriverSymbolIndex::projectRoot(const QString &fileName)
+{
+    const QString home(QDir::homePath());
+    const QString temp(QDir::tempPath());
+
+    for (QDir dir(QFileInfo(fileName).absolutePath()); !dir.isRoot(); ) {
+        const QString path(dir.absolutePath());
+        if (path == home || path == temp) break;
+        if (dir.exists(".git") || QFileInfo(dir, "features").isDir()) return path;
+        if (!dir.cdUp()) break;
+    }
+    return QString();
+}
+
+
+QString TDriverSymbolIndex::rootOf(const QString &path) const
+{
+    for (QHash<QString, qint64>::const_iterator it = roots.constBegin(); it != roots.constEnd(); ++it) {
+        if (path == it.key() || path.startsWith(it.key() + '/')) return it.key();
+    }
+    return QString();
+}
+
+
+void TDriverSymbolIndex::addFile(const QString &fileName)
+{
+    if (fileName.isEmpty()) return;
+    const QString dir(projectRoot(fileName));
+
+    if (dir.isNull()) {
+        // loose file is kept in index only for this session
+        pendingFiles.insert(QFileInfo(fileName).absoluteFilePath());
+        updateTimer->start();
+    }
+    else {
+        addRoot(dir);
+    }
+}
+
+
+void TDriverSymbolIndex::addRoot(const QString &dir)
+{
+    const QString covering(rootOf(dir));
+    if (!covering.isNull()) {
+        roots[covering] = QDateTime::currentMSecsSinceEpoch();
+        saveTimer->start();
+        return;
+    }
+
+    // new root covers roots inside it
+    QHash<QString, qint64>::iterator it = roots.begin();
+    while (it != roots.end()) {
+        if (it.key().startsWith(dir + '/')) it = roots.erase(it);
+        else ++it;
+    }
+    roots.insert(dir, QDateTime::currentMSecsSinceEpoch());
+    pendingDirs << dir;
+    updateTimer->start();
+    saveTimer->start();
+}
+
+
+void TDriverSymbolIndex::fileChanged(const QString &path)
+{
+    pendingFiles.insert(path);
+    updateTimer->start();
+}
+
+
+void TDriverSymbolIndex::directoryChanged(const QString &path)
+{
+    // files were added, removed or renamed
+    pendingDirs << path;
+    updateTimer->start();
+}
+
+
+void TDriverSymbolIndex::startUpdate()
+{
+    // updateFinished starts pending update when running one is done
+    if (scanWatcher->isRunning()) return;
+    if (pendingDirs.isEmpty() && pendingFiles.isEmpty()) return;
+
+    StampHash stamps;
+    stamps.reserve(entries.size());
+    for (QHash<QString, FileEntry>::const_iterator it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        stamps.insert(it.key(), qMakePair(it->modified, it->size));
+    }
+
+    QStringList dirs(pendingDirs);
+    dirs.removeDuplicates();
+    QStringList files(pendingFiles.toList());
+    pendingDirs.clear();
+    pendingFiles.clear();
+
+    scanWatcher->setFuture(QtConcurrent::run(&TDriverSymbolIndex::scan, dirs, files, stamps));
+}
+
+
+// executed in worker thread
+TDriverSymbolIndex::ScanResult TDriverSymbolIndex::scan(QStringList dirs, QStringList files, StampHash stamps)
+{
+    ScanResult ret;
+    QSet<QString> candidates(files.toSet());
+
+    foreach (const QString &dir, dirs) {
+        // listed even if removed, so that its files get removed from index
+        ret.scannedDirs << dir;
+        if (!QFileInfo(dir).isDir()) continue;
+
+        ret.foundDirs << dir;
+        QDirIterator dirIt(dir, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (dirIt.hasNext()) ret.foundDirs << dirIt.next();
+
+        QDirIterator fileIt(dir, QStringList() << "*.rb", QDir::Files | QDir::Readable, QDirIterator::Subdirectories);
+        while (fileIt.hasNext() && candidates.size() < maxIndexedFiles) {
+            const QString path(fileIt.next());
+            ret.foundFiles << path;
+            candidates.insert(path);
+        }
+    }
+
+    foreach (const QString &path, candidates) {
+        QFileInfo info(path);
+        if (!info.exists()) {
+            ret.removedFiles << path;
+            continue;
+        }
+
+        const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+        StampHash::const_iterator stamp = stamps.constFind(path);
+        if (stamp != stamps.constEnd() && stamp->first == modified && stamp->second == info.size()) continue;
+
+        FileEntry entry;
+        entry.modified = modified;
+        entry.size = info.size();
+        entry.symbols = parseFile(path);
+        ret.parsed.insert(path, entry);
+    }
+
+    return ret;
+}
+
+
+void TDriverSymbolIndex::updateFinished()
+{
+    const ScanResult result = scanWatcher->result();
+    bool changed = !result.parsed.isEmpty();
+
+    // remove files which disappeared from scanned directories
+    const QSet<QString> found(result.foundFiles.toSet());
+    foreach (const QString &dir, result.scannedDirs) {
+        const QString prefix(dir + '/');
+        QHash<QString, FileEntry>::iterator it = entries.begin();
+        while (it != entries.end()) {
+            if (it.key().startsWith(prefix) && !found.contains(it.key())) {
+                it = entries.erase(it);
+                changed = true;
+            }
+            else ++it;
+        }
+    }
+    foreach (const QString &path, result.removedFiles) {
+        if (entries.remove(path) > 0) changed = true;
+    }
+    for (QHash<QString, FileEntry>::const_iterator it = result.parsed.constBegin(); it != result.parsed.constEnd(); ++it) {
+        entries.insert(it.key(), it.value());
+    }
+
+    {
+        const QStringList watchedFiles(fsWatcher->files());
+        const QStringList watchedDirs(fsWatcher->directories());
+        QSet<QString> watched((watchedFiles + watchedDirs).toSet());
+        QStringList newPaths;
+        int dirBudget = maxWatchedDirs - watchedDirs.size();
+        foreach (const QString &dir, result.foundDirs) {
+            if (dirBudget <= 0) break;
+            if (!watched.contains(dir)) {
+                newPaths << dir;
+                watched.insert(dir);
+                --dirBudget;
+            }
+        }
+        int fileBudget = maxWatchedFiles - watchedFiles.size();
+        foreach (const QString &path, result.foundFiles + result.parsed.keys()) {
+            if (fileBudget <= 0) break;
+            if (!watched.contains(path)) {
+                newPaths << path;
+                watched.insert(path);
+                --fileBudget;
+            }
+        }
+        if (!newPaths.isEmpty()) fsWatcher->addPaths(newPaths);
+    }
+
+    if (changed) {
+        rebuildLookup();
+        saveTimer->start();
+        emit indexUpdated();
+    }
+
+    if (!pendingDirs.isEmpty() || !pendingFiles.isEmpty()) updateTimer->start();
+}
+
+
+void TDriverSymbolIndex::rebuildLookup()
+{
+    lookup.clear();
+    steps.clear();
+
+    for (QHash<QString, FileEntry>::const_iterator it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        foreach (const Symbol &symbol, it->symbols) {
+            LookupEntry entry = { symbol.name, it.key(), symbol.line, symbol.kind };
+            if (symbol.kind == StepSymbol) steps << entry;
+            else lookup << entry;
+        }
+    }
+    std::sort(lookup.begin(), lookup.end());
+}
+
+
+QStringList TDriverSymbolIndex::completions(const QString &prefix, int maxCount) const
+{
+    QStringList ret;
+    const LookupEntry key = { prefix, QString(), 0, 0 };
+
+    QVector<LookupEntry>::const_iterator it = std::lower_bound(lookup.constBegin(), lookup.constEnd(), key);
+    for (; it != lookup.constEnd() && it->name.startsWith(prefix) && ret.size() < maxCount; ++it) {
+        if (ret.isEmpty() || ret.last() != it->name) ret << it->name;
+    }
+    return ret;
+}
+
+
+QList<TDriverSymbolIndex::Location> TDriverSymbolIndex::definitions(const QString &name) const
+{
+    QList<Location> ret;
+    const LookupEntry key = { name, QString(), 0, 0 };
+
+    QVector<LookupEntry>::const_iterator it = std::lower_bound(lookup.constBegin(), lookup.constEnd(), key);
+    for (; it != lookup.constEnd() && it->name == name; ++it) {
+        Location location = { it->fileName, it->line, it->kind };
+        ret << location;
+    }
+    return ret;
+}
+
+
+QList<TDriverSymbolIndex::Location> TDriverSymbolIndex::stepDefinitions(const QString &stepText) const
+{
+    QList<Location> ret;
+    foreach (const LookupEntry &step, steps) {
+        QRegExp rx(step.name);
+        if (rx.isValid() && rx.indexIn(stepText) >= 0) {
+            Location location = { step.fileName, step.line, step.kind };
+            ret << location;
+        }
+    }
+    return ret;
+}
+
+
+QVector<TDriverSymbolIndex::Symbol> TDriverSymbolIndex::parseFile(const QString &fileName)
+{
+    QVector<Symbol> ret;
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly | QFile::Text)) return ret;
+
+    // QRegExp keeps match state, so these can't be shared between threads
+    QRegExp defEx("^\\s*def\\s+(?:[A-Za-z_][A-Za-z0-9_]*\\.)?([A-Za-z_][A-Za-z0-9_]*[?!=]?)");
+    QRegExp classEx("^\\s*(?:class|module)\\s+(?:[A-Z][A-Za-z0-9_]*::)*([A-Z][A-Za-z0-9_]*)");
+    QRegExp stepEx("^\\s*(?:Given|When|Then|And|But|Step)\\s*\\(?\\s*/(.*)/[a-z]*\\s*\\)?\\s*(?:do|\\{)");
+    QRegExp varEx("^\\s*(@{0,2}[a-z_][A-Za-z0-9_]*)\\s*=[^=~].*(?:TDriver\\.(?:sut|connect_sut)\\b|\\.run\\b)");
+
+    QTextStream in(&file);
+    in.setCodec("UTF-8");
+    qint32 lineNum = 0;
+
+    while (!in.atEnd()) {
+        const QString line(in.readLine());
+        ++lineNum;
+
+        Symbol symbol;
+        symbol.line = lineNum;
+        if (defEx.indexIn(line) >= 0) {
+            symbol.name = defEx.cap(1);
+            symbol.kind = MethodSymbol;
+        }
+        else if (classEx.indexIn(line) >= 0) {
+            symbol.name = classEx.cap(1);
+            symbol.kind = ClassSymbol;
+        }
+        else if (stepEx.indexIn(line) >= 0) {
+            symbol.name = stepEx.cap(1);
+            symbol.kind = StepSymbol;
+        }
+        else if (varEx.indexIn(line) >= 0) {
+            symbol.name = varEx.cap(1);
+            symbol.kind = VariableSymbol;
+        }
+        else continue;
+
+        ret << symbol;
+    }
+
+    return ret;
+}
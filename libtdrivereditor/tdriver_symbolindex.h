@@ -0,0 +1,138 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#ifndef TDRIVER_SYMBOLINDEX_H
+#define TDRIVER_SYMBOLINDEX_H
+
+#include "libtdrivereditor_global.h"
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QFileSystemWatcher;
+class QTimer;
+
+// Definitions found in Ruby files under project directories: methods, classes and modules,
+// step definitions and SUT/application variables. Files are parsed in a worker thread and
+// kept up to date by watching them. Index is saved between sessions, so at startup only
+// files changed since are parsed again. Projects not opened for a while are forgotten.
+class LIBTDRIVEREDITORSHARED_EXPORT TDriverSymbolIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum SymbolKind { MethodSymbol = 'm', ClassSymbol = 'c', StepSymbol = 's', VariableSymbol = 'v' };
+
+    struct Symbol {
+        QString name; // regular expression for step definitions
+        qint32 line;
+        qint8 kind;
+    };
+
+    struct FileEntry {
+        qint64 modified; // msecs since epoch
+        qint64 size;
+        QVector<Symbol> symbols;
+        FileEntry() : modified(0), size(0) {}
+    };
+
+    struct Location {
+        QString fileName;
+        int line;
+        int kind;
+    };
+
+    explicit TDriverSymbolIndex(QObject *parent = 0);
+    ~TDriverSymbolIndex();
+
+    // names of methods, classes and variables starting with prefix, sorted and without duplicates
+    QStringList completions(const QString &prefix, int maxCount = 200) const;
+    // definitions of methods, classes and variables with given name
+    QList<Location> definitions(const QString &name) const;
+    // step definitions matching step text (without Given/When/Then keyword)
+    QList<Location> stepDefinitions(const QString &stepText) const;
+
+    static QVector<Symbol> parseFile(const QString &fileName);
+
+signals:
+    void indexUpdated();
+
+public slots:
+    // project containing the file (directory with .git or features/) is indexed recursively
+    // and remembered between sessions, file outside any project is indexed alone
+    void addFile(const QString &fileName);
+
+private slots:
+    void fileChanged(const QString &path);
+    void directoryChanged(const QString &path);
+    void startUpdate();
+    void updateFinished();
+    bool save();
+
+private:
+    typedef QHash<QString, QPair<qint64, qint64> > StampHash;
+
+    struct ScanResult {
+        QStringList scannedDirs;
+        QStringList foundFiles; // all files found under scannedDirs
+        QStringList foundDirs;
+        QStringList removedFiles;
+        QHash<QString, FileEntry> parsed;
+    };
+
+    struct LookupEntry {
+        QString name;
+        QString fileName;
+        int line;
+        int kind;
+        bool operator<(const LookupEntry &other) const { return name < other.name; }
+    };
+
+    static ScanResult scan(QStringList dirs, QStringList files, StampHash stamps);
+    static QString cacheFileName();
+    static QString projectRoot(const QString &fileName);
+    bool load();
+    void pruneRoots();
+    void rebuildLookup();
+    void addRoot(const QString &dir);
+    QString rootOf(const QString &path) const;
+
+    QHash<QString, qint64> roots; // project directory, last opened in msecs since epoch
+    QHash<QString, FileEntry> entries;
+    QVector<LookupEntry> lookup; // sorted by name
+    QVector<LookupEntry> steps;
+
+    QStringList pendingDirs;
+    QSet<QString> pendingFiles;
+    QTimer *updateTimer;
+    QTimer *saveTimer;
+    QFutureWatcher<ScanResult> *scanWatcher;
+    QFileSystemWatcher *fsWatcher;
+};
+
+#endif // TDRIVER_SYMBOLINDEX_H
@@ -27,6 +27,9 @@
 #include "tdriver_rubyinteract.h"
 #include "tdriver_editor_common.h"
 #include "tdriver_editbar.h"
+#include "tdriver_filesearchpanel.h"
+#include "tdriver_symbolindex.h"
+#include "tdriver_largefileview.h"
 #include "tdriver_combolineedit.h"
 
 
@@ -50,6 +53,12 @@
 #include <QMenuBar>
 #include <QMenu>
 #include <QDockWidget>
+#include <QHash>
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QProgressDialog>
+#include <QSaveFile>
+#include <QtConcurrentRun>
 #include <QSet>
 #include <QFont>
 #include <QPushButton>
@@ -59,6 +68,9 @@
 #include <QLineEdit>
 #include <QMimeData>
 
+// larger files are inserted to editor in chunks of this many characters
+static const int loadChunkSize = 256*1024;
+
 static inline QString strippedName(const QString &fullFileName) {
     return QFileInfo(fullFileName).fileName();
 }
@@ -77,6 +89,8 @@ TDriverTabbedEditor::TDriverTabbedEditor(QWidget *shortcutParent, QWidget *paren
     editorFont(),
     proceedRunPending(false),
     editBarP(new TDriverEditBar(this)),
+    fileSearchP(new TDriverFileSearchPanel(this, this)),
+    symbolIndex(new TDriverSymbolIndex(this)),
     rubyHighlighter(new TDriverRubyHighlighter()),
     plainHighlighter(new TDriverHighlighter()),
     needRunPreparations(false),
@@ -107,6 +121,7 @@ TDriverTabbedEditor::TDriverTabbedEditor(QWidget *shortcutParent, QWidget *paren
 
     connect(editBarP, SIGNAL(requestUnfocus()), SLOT(focusCurrent()));
     connect(editBarP, SIGNAL(routedAutoRefreshInteractive()), SIGNAL(requestQuickRefresh()));
+    connect(fileSearchP, SIGNAL(fileLineActivated(QString)), SLOT(gotoLine(QString)));
 
     // create some non-global shortcuts
     {
@@ -143,6 +158,7 @@ void TDriverTabbedEditor::disconnectTabSignals()
     disconnect(selectAllAct, SIGNAL(triggered()), 0, 0);
 
     disconnect(commentCodeAct, SIGNAL(triggered()), 0, 0);
+    disconnect(gotoDefinitionAct, SIGNAL(triggered()), 0, 0);
 
     disconnect(toggleUsingTabulatorsModeAct, SIGNAL(toggled(bool)), 0, 0);
     disconnect(toggleRubyModeAct, SIGNAL(toggled(bool)), 0, 0);
@@ -172,6 +188,7 @@ void TDriverTabbedEditor::connectTabSignals(TDriverCodeTextEdit *editor)
     connect(selectAllAct, SIGNAL(triggered()), editor, SLOT(selectAll()));
 
     connect(commentCodeAct, SIGNAL(triggered()), editor, SLOT(commentCode()));
+    connect(gotoDefinitionAct, SIGNAL(triggered()), editor, SLOT(gotoDefinition()));
 
     connect(editor, SIGNAL(copyAvailable(bool)), copyAct, SLOT(setEnabled(bool)));
     connect(editor, SIGNAL(copyAvailable(bool)), cutAct, SLOT(setEnabled(bool)));
@@ -214,11 +231,15 @@ void TDriverTabbedEditor::currentChangeAction(int index)
     //qDebug() << FFL << "Tab changed to" << index;
     disconnectTabSignals();
     TDriverCodeTextEdit *editor = qobject_cast<TDriverCodeTextEdit*>(currentWidget());
+    TDriverLargeFileView *view = qobject_cast<TDriverLargeFileView*>(currentWidget());
     if (editor) {
         connectTabSignals(editor);
         editor->madeCurrent();
         emit documentNameChanged(editor->fileName());
     }
+    else if (view) {
+        emit documentNameChanged(view->fileName());
+    }
     else {
         qWarning("Warning! Unknown widget type in tab, some editor signals not connected.");
     }
@@ -350,6 +371,13 @@ void TDriverTabbedEditor::createActions()
     selectAllAct->setStatusTip(tr("Select all text of current file"));
     editActs.append(selectAllAct);
 
+    findInFilesAct = new QAction(tr("&Find in Files..."), this);
+    findInFilesAct->setObjectName("editor findinfiles");
+    findInFilesAct->setShortcut(QKeySequence(tr("Ctrl+Shift+H")));
+    findInFilesAct->setStatusTip(tr("Search and replace text in all files of a directory"));
+    editActs.append(findInFilesAct);
+    connect(findInFilesAct, SIGNAL(triggered()), this, SLOT(showFileSearch()));
+
     // a tdriver_codetextedit action
     commentCodeAct = new QAction(tr("&Comment/Uncomment region/line"), this);
     commentCodeAct->setObjectName("editor commentcode");
@@ -357,6 +385,13 @@ void TDriverTabbedEditor::createActions()
     commentCodeAct->setStatusTip(tr("Comments or uncomments selected code or current line"));
     codeActs.append(commentCodeAct);
 
+    // a tdriver_codetextedit action
+    gotoDefinitionAct = new QAction(tr("&Go to Definition"), this);
+    gotoDefinitionAct->setObjectName("editor gotodefinition");
+    gotoDefinitionAct->setShortcut(QKeySequence(Qt::Key_F12));
+    gotoDefinitionAct->setStatusTip(tr("Open definition of method, class, variable or step under cursor"));
+    codeActs.append(gotoDefinitionAct);
+
 
     // a tdriver_codetextedit action
     toggleUsingTabulatorsModeAct = new QAction(tr("&Use TAB characters"), this);
@@ -657,6 +692,13 @@ bool TDriverTabbedEditor::closeTab(int index)
             return true;
         }
     }
+    else if (widget(index)) {
+        // other tabs, like large file viewer, have nothing to save
+        QWidget *other = widget(index);
+        removeTab(index);
+        delete other;
+        return true;
+    }
     return false;
 }
 
@@ -695,6 +737,9 @@ void TDriverTabbedEditor::newFile(QString fileName)
             this, SLOT(documentModification(bool)));
     connect(newEdit, SIGNAL(modesChanged()),
             this, SLOT(editorModeChange()));
+    connect(newEdit, SIGNAL(requestGotoLine(QString)),
+            this, SLOT(gotoLine(QString)));
+    newEdit->setSymbolIndex(symbolIndex);
 
     connect(newEdit, SIGNAL(addedBreakpoint(MEC::Breakpoint)),
             this, SIGNAL(addedBreakpoint(MEC::Breakpoint)));
@@ -707,6 +752,7 @@ void TDriverTabbedEditor::newFile(QString fileName)
             newEdit, SLOT(popupInteractiveCompletion(QObject*,QByteArray,QStringList)));
     connect(irConsole, SIGNAL(completionError(QObject*,QByteArray,QStringList)),
             newEdit, SLOT(errorInteractiveCompletion(QObject*,QByteArray,QStringList)));
+    if (irConsole) newEdit->setCompletionCache(irConsole->completionCache());
 
     connect(newEdit, SIGNAL(requestInteractiveEvaluation(QByteArray)),
             irConsole, SLOT(evalStatement(QByteArray)));
@@ -928,6 +974,18 @@ void TDriverTabbedEditor::showIrConsole()
 }
 
 
+void TDriverTabbedEditor::showFileSearch()
+{
+    // panel is placed in a container (dock) by the application
+    QWidget *container = fileSearchP->parentWidget();
+    if (container && container != this) {
+        container->setVisible(true);
+        container->raise();
+    }
+    fileSearchP->focusSearchText();
+}
+
+
 bool TDriverTabbedEditor::loadFile(QString fileName, bool fromTemplate, TDriverCodeTextEdit *replaceIn)
 {
     qDebug() << FFL << fileName;
@@ -945,6 +1003,16 @@ bool TDriverTabbedEditor::loadFile(QString fileName, bool fromTemplate, TDriverC
                              .arg(file.errorString()));
     }
 
+    else if (!fromTemplate && !replaceIn
+             && file.size() >= QSettings().value("editor/viewerfilesize", 32*1024*1024).toLongLong()
+             && QMessageBox::question(this, tr("TDriver Editor"),
+                                      tr("File '%1' is %2 MB.\nOpen it in read-only viewer instead of editor?")
+                                      .arg(fileName)
+                                      .arg(file.size() / (1024*1024)),
+                                      QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes) == QMessageBox::Yes) {
+        ret = openInViewer(fileName);
+    }
+
     else {
         TDriverCodeTextEdit *editor = NULL;
         QApplication::setOverrideCursor(Qt::WaitCursor);
@@ -995,16 +1063,35 @@ bool TDriverTabbedEditor::loadFile(QString fileName, bool fromTemplate, TDriverC
         }
         editor->setFileCodec(codec);
         editor->setFileCodecUtfBom(haveBom);
+        bool loaded = true;
         if (replaceIn) {
             QTextCursor tc = editor->textCursor();
             tc.beginEditBlock();
             tc.select(QTextCursor::Document);
-            tc.insertText(stringData);
+            tc.removeSelectedText();
+            loaded = insertTextChunked(tc, stringData, fileName);
             tc.endEditBlock();
+            if (!loaded) editor->document()->undo();
+        }
+        else if (stringData.size() > loadChunkSize) {
+            editor->document()->setUndoRedoEnabled(false);
+            QTextCursor tc(editor->document());
+            loaded = insertTextChunked(tc, stringData, fileName);
+            editor->document()->setUndoRedoEnabled(true);
         }
         else {
             editor->setPlainText(stringData);
         }
+
+        if (!loaded) {
+            qDebug() << FCFL << "loading canceled" << fileName;
+            QApplication::restoreOverrideCursor();
+            if (!replaceIn) {
+                editor->document()->setModified(false);
+                closeTab(indexOf(editor));
+            }
+            return false;
+        }
         editor->document()->setModified(false);
         QString oldFileName = editor->fileName();
         editor->setFileName(fileName, fromTemplate);
@@ -1017,6 +1104,11 @@ bool TDriverTabbedEditor::loadFile(QString fileName, bool fromTemplate, TDriverC
             recentFileUpdate(fileName);
         }
 
+        if (!fromTemplate && (fileName.endsWith(".rb") || fileName.endsWith(".feature"))) {
+            // index project of the file for completion and go to definition
+            symbolIndex->addFile(fileName);
+        }
+
         updateTab();
 
         //statusBar()->showMessage(tr("File loaded"), 2000);
@@ -1036,6 +1128,83 @@ bool TDriverTabbedEditor::loadFile(QString fileName, bool fromTemplate, TDriverC
 }
 
 
+// Inserts text at cursor in line aligned chunks, so that loading a large file
+// shows progress and can be canceled. Returns false if canceled.
+bool TDriverTabbedEditor::insertTextChunked(QTextCursor &cursor, const QString &text, const QString &fileName)
+{
+    if (text.size() <= loadChunkSize) {
+        cursor.insertText(text);
+        return true;
+    }
+
+    QProgressDialog progress(tr("Loading file '%1'...").arg(fileName), tr("Cancel"), 0, text.size(), this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+
+    int pos = 0;
+    while (pos < text.size()) {
+        int end = text.indexOf('\n', pos + loadChunkSize);
+        end = (end < 0) ? text.size() : end + 1;
+        cursor.insertText(text.mid(pos, end - pos));
+        pos = end;
+        progress.setValue(pos); // processes events
+        if (progress.wasCanceled()) return false;
+    }
+    return true;
+}
+
+
+bool TDriverTabbedEditor::openInViewer(const QString &fileName)
+{
+    TDriverLargeFileView *view = new TDriverLargeFileView(this);
+    view->setFont(editorFont);
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool ok = view->openFile(fileName);
+    QApplication::restoreOverrideCursor();
+
+    if (!ok) {
+        QMessageBox::warning(this, tr("TDriver Editor"),
+                             tr("Can't view file '%1':\n%2.")
+                             .arg(fileName)
+                             .arg(view->errorString()));
+        delete view;
+        return false;
+    }
+
+    int index = addTab(view, QString());
+    updateTab(index);
+    setCurrentIndex(index);
+    view->setFocus();
+    recentFileUpdate(fileName);
+    return true;
+}
+
+
+// executed in worker thread, returns error string or null string on success
+static QString writeTextFile(const QString &fileName, const QString &text, QTextCodec *codec, bool haveBom)
+{
+    // QSaveFile writes to temporary file, which replaces target file only after successful commit
+    QSaveFile file(fileName);
+    file.setDirectWriteFallback(true);
+    if (!file.open(QFile::WriteOnly | QFile::Text)) return file.errorString();
+
+    {
+        QTextStream outStream(&file);
+        if (codec) outStream.setCodec(codec);
+        outStream.setGenerateByteOrderMark(haveBom);
+        outStream << text;
+        outStream.flush();
+        if (outStream.status() != QTextStream::Ok) {
+            file.cancelWriting();
+        }
+    }
+
+    if (!file.commit()) return file.errorString();
+    return QString();
+}
+
+
 bool TDriverTabbedEditor::saveFile(QString fileName, int index, bool resetEncoding)
 {
     if (index < 0) index = currentIndex();
@@ -1056,32 +1225,32 @@ bool TDriverTabbedEditor::saveFile(QString fileName, int index, bool resetEncodi
 
     }
 
-    {
-        QFile file(fileName);
-        if (!file.open(QFile::WriteOnly | QFile::Text)) {
-            QMessageBox::warning(this, tr("Recent Files"),
-                                 tr("Cannot write file %1:\n%2.")
-                                 .arg(fileName)
-                                 .arg(file.errorString()));
-            updateTab(index);
+    editor->disableWatcher();
+    QApplication::setOverrideCursor(Qt::WaitCursor);
 
-            return false;
-        }
+    // encoding and writing is done in worker thread, window is repainted but doesn't take input meanwhile
+    QFutureWatcher<QString> saveWatcher;
+    QEventLoop waitLoop;
+    connect(&saveWatcher, SIGNAL(finished()), &waitLoop, SLOT(quit()));
+    saveWatcher.setFuture(QtConcurrent::run(writeTextFile, fileName, editor->toPlainText(),
+                                            editor->fileCodec(), editor->fileCodecUtfBom()));
+    waitLoop.exec(QEventLoop::ExcludeUserInputEvents);
+    const QString writeError(saveWatcher.result());
 
-        editor->disableWatcher();
-        QApplication::setOverrideCursor(Qt::WaitCursor);
+    editor->enableWatcher();
+    QApplication::restoreOverrideCursor();
 
-        {
-            QTextStream outStream(&file);
-            if (editor->fileCodec()) outStream.setCodec(editor->fileCodec());
-            outStream.setGenerateByteOrderMark(editor->fileCodecUtfBom());
-            outStream << editor->toPlainText();
-        }
-        file.close();
+    if (!writeError.isNull()) {
+        QMessageBox::warning(this, tr("Recent Files"),
+                             tr("Cannot write file %1:\n%2.")
+                             .arg(fileName)
+                             .arg(writeError));
+        updateTab(index);
+
+        return false;
     }
-    editor->enableWatcher();
+
     editor->document()->setModified(false);
-    QApplication::restoreOverrideCursor();
 
     updateTab(index);
 
@@ -1141,7 +1310,18 @@ void TDriverTabbedEditor::updateTab(int index)
     if (index < 0) index = currentIndex();
 
     TDriverCodeTextEdit *editor = qobject_cast<TDriverCodeTextEdit*>(widget(index));
-    if (editor) {
+    if (!editor) {
+        TDriverLargeFileView *view = qobject_cast<TDriverLargeFileView*>(widget(index));
+        if (view) {
+            label = tr("%1 (read-only, %2)").arg(strippedName(view->fileName()))
+                    .arg(QString::fromLatin1(view->fileCodec()->name()));
+            label.replace(QString("&"), QString("&&")); // single & defines keyboard shortcut
+            setTabText(index, label);
+            setTabToolTip(index, view->fileName());
+        }
+        return;
+    }
+    else {
         label = strippedName(editor->fileName());
         editor->setObjectName("editor file "+ label);
         setTabToolTip(index, editor->fileName());
@@ -1417,7 +1597,9 @@ void TDriverTabbedEditor::setEditorFont(QFont font)
     editorFont = font;
     for (int ind = 0; ind < count() ; ++ind) {
         TDriverCodeTextEdit *editor = qobject_cast<TDriverCodeTextEdit*>(widget(ind));
+        TDriverLargeFileView *view = qobject_cast<TDriverLargeFileView*>(widget(ind));
         if (editor) setEditorFontAndTabWidth(editor, editorFont);
+        else if (view) view->setFont(editorFont);
     }
 }
 
@@ -1474,12 +1656,25 @@ void TDriverTabbedEditor::addBreakpoint(struct MEC::Breakpoint bp)
 
 void TDriverTabbedEditor::addBreakpointList(QList<struct MEC::Breakpoint> bpList)
 {
-    // TODO: optimization: do this differently to avoid O(breakpoints * tabs)
+    // bpList is assumed to have all active breakpoints,
+    // editors are reset and indexed by file once instead of searching all tabs for every breakpoint
+    QMultiHash<QString, TDriverCodeTextEdit*> fileEditors;
+    for (int ind = 0; ind < count() ; ++ind) {
+        TDriverCodeTextEdit *editor = qobject_cast<TDriverCodeTextEdit*>(widget(ind));
+        if (editor) {
+            editor->rdebugBreakpointReset();
+            fileEditors.insert(editor->fileName(), editor);
+        }
+    }
 
-    resetBreakpoints(); // bpList is assumed to have all active breakpoints
-    MEC::Breakpoint bp;
-    foreach(bp, bpList) {
-        addBreakpoint(bp);
+    foreach (const MEC::Breakpoint &bp, bpList) {
+        QList<TDriverCodeTextEdit*> editors(fileEditors.values(bp.file));
+        if (editors.isEmpty()) {
+            qDebug() << FFL << "rdebug reported a breakpoint to unopened file: " << MEC::dumpBreakpoint(&bp);
+        }
+        foreach (TDriverCodeTextEdit *editor, editors) {
+            editor->rdebugBreakpoint(bp);
+        }
     }
 }
 
@@ -1501,6 +1696,12 @@ void TDriverTabbedEditor::showFileLine(const QString fileName, int lineNum)
             currentWidget()->activateWindow();
             currentWidget()->setFocus();
         }
+        else if (TDriverLargeFileView *view = findViewer(fileName)) {
+            view->gotoLine(lineNum);
+            setCurrentWidget(view);
+            view->activateWindow();
+            view->setFocus();
+        }
     }
 }
 
@@ -1569,7 +1770,7 @@ QList<TDriverCodeTextEdit*> TDriverTabbedEditor::setupLineJump(const QString &fi
         }
     }
 
-    if (ret.isEmpty()) {
+    if (ret.isEmpty() && !findViewer(fileName)) {
         // not set yet, ie. file not found in tabs, try to open!
         qDebug() << FFL << fileName <<"not open, opening";
         if (loadFile(fileName)) {
@@ -1578,7 +1779,9 @@ QList<TDriverCodeTextEdit*> TDriverTabbedEditor::setupLineJump(const QString &fi
                 qDebug() << FFL << "made new tab for" << editor->fileName();
                 ret.append(editor);
             }
-            else qWarning("loadFile '%s' didn't create TDriverCodeTextEdit", qPrintable(fileName));
+            else if (!qobject_cast<TDriverLargeFileView*>(currentWidget())) {
+                qWarning("loadFile '%s' didn't create TDriverCodeTextEdit", qPrintable(fileName));
+            }
         }
         else {
             qDebug() << FFL << "loading file failed:" << fileName;
@@ -1589,6 +1792,16 @@ QList<TDriverCodeTextEdit*> TDriverTabbedEditor::setupLineJump(const QString &fi
 }
 
 
+TDriverLargeFileView *TDriverTabbedEditor::findViewer(const QString &fileName) const
+{
+    for (int ind = 0; ind < count() ; ++ind) {
+        TDriverLargeFileView *view = qobject_cast<TDriverLargeFileView*>(widget(ind));
+        if (view && view->fileName() == fileName) return view;
+    }
+    return NULL;
+}
+
+
 void TDriverTabbedEditor::updateEditorParams()
 {
     for (int ind = 0; ind < count() ; ++ind) {
@@ -39,9 +39,12 @@ class QCloseEvent;
 class QUrl;
 
 class TDriverEditBar;
+class TDriverFileSearchPanel;
+class TDriverSymbolIndex;
 class TDriverRunConsole;
 class TDriverDebugConsole;
 class TDriverRubyInteract;
+class TDriverLargeFileView;
 class TDriverCodeTextEdit;
 class TDriverExecuteDialog;
 
@@ -62,6 +65,7 @@ public:
     void setTDriverParamMap(const QMap<QString, QString> &map);
     void setSutParamMap(const QMap<QString, QString> &map);
     TDriverEditBar *searchBar() { return editBarP; }
+    TDriverFileSearchPanel *fileSearchPanel() { return fileSearchP; }
 
     const QList<QAction *> &fileActions() const { return fileActs; }
     const QList<QAction *> &recentFileActions() const { return recentFileActs; }
@@ -152,6 +156,7 @@ public slots:
     void setDebugConsoleVisible(bool);
     void setIRConsoleVisible(bool);
     void showIrConsole();
+    void showFileSearch();
 
     bool mainCloseEvent(QCloseEvent *);
 
@@ -175,6 +180,10 @@ private slots:
 
 private:
     QList<TDriverCodeTextEdit*> setupLineJump(const QString &file, int lineNum);
+    // read-only viewer tab of file, files opened in viewer have no editor tab
+    TDriverLargeFileView *findViewer(const QString &fileName) const;
+    bool insertTextChunked(QTextCursor &cursor, const QString &text, const QString &fileName);
+    bool openInViewer(const QString &fileName);
     void updateEditorParams();
 
 private:
@@ -186,6 +195,8 @@ private:
     bool proceedRunPending;
 
     TDriverEditBar *editBarP;
+    TDriverFileSearchPanel *fileSearchP;
+    TDriverSymbolIndex *symbolIndex;
 
     TDriverRubyHighlighter *rubyHighlighter;
     TDriverHighlighter *plainHighlighter;
@@ -232,9 +243,11 @@ private:
     QAction *copyAct;
     QAction *pasteAct;
     QAction *selectAllAct;
+    QAction *findInFilesAct;
 
     // code manipulation actions
     QAction *commentCodeAct;
+    QAction *gotoDefinitionAct;
 
     // option actions
     QAction *toggleUsingTabulatorsModeAct;
@@ -22,6 +22,7 @@
 #include "tdriver_standardfeaturmodel.h"
 
 #include <tdriver_debug_macros.h>
+#include <tdriver_filewatcher.h>
 
 #include <QtGui>
 #include <QStyledItemDelegate>
@@ -65,6 +66,9 @@ TDriverFeaturAbstractView::TDriverFeaturAbstractView(const QString &title, QWidg
 
     mainLayout->addWidget(__listView);
 
+    connect(TDriverFileWatcher::globalInstance(), SIGNAL(filesChanged(QObject*,QStringList)),
+            SLOT(watchedFilesChanged(QObject*,QStringList)));
+
     setModel(new TDriverStandardFeaturModel(this));
     //connect(selectionModel(), SIGNAL(currentChanged(QModelIndex,QModelIndex)), SLOT(resetPathFromIndex(QModelIndex)));
 
@@ -102,6 +106,11 @@ void TDriverFeaturAbstractView::setPath(const QString &path)
     }
     __pathInfo->setFile(tmpPath);
 
+    // rescan when shown file or directory changes on disk
+    TDriverFileWatcher::globalInstance()->unwatch(__watchedPath, this);
+    __watchedPath = (tmpPath.isEmpty()) ? QString() : __pathInfo->absoluteFilePath();
+    TDriverFileWatcher::globalInstance()->watch(__watchedPath, this);
+
     QString suffix;
     if (!hasLineNum && pathInfo().isDir() && !path.endsWith('/')) {
         suffix = QChar('/');
@@ -156,6 +165,17 @@ void TDriverFeaturAbstractView::aFileChanged(const QString &path)
 }
 
 
+void TDriverFeaturAbstractView::watchedFilesChanged(QObject *client, QStringList paths)
+{
+    Q_UNUSED(paths);
+    if (client != this) return; // not for us
+
+    // one rescan for any number of changes, hidden view is rescanned when shown
+    if (isVisible()) reScan();
+    else setPendingScan();
+}
+
+
 void TDriverFeaturAbstractView::resetPath(const QString &path)
 {
     qDebug() << FCFL << path;
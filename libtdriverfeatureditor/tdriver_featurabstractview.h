@@ -23,6 +23,7 @@
 #include "libtdriverfeatureditor_global.h"
 
 #include <QWidget>
+#include <QStringList>
 
 class QString;
 class QStyledItemDelegate;
@@ -105,6 +106,7 @@ public slots:
 
 protected slots:
     virtual void doFileDialog();
+    virtual void watchedFilesChanged(QObject *client, QStringList paths);
 
 protected:
     void setLocationBox(const QString &text);
@@ -126,6 +128,7 @@ private:
     QPushButton *__fileButton;
     QComboBox *__locationBox;
     QFileInfo *__pathInfo;
+    QString __watchedPath;
     int __pathLine;
     QString __scanPattern;
     QString __scanPattern2;
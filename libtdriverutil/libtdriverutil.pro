@@ -45,6 +45,7 @@ SOURCES += tdriver_util.cpp \
     tdriver_rubyinterface.cpp \
     tdriver_rbiprotocol.cpp \
     tdriver_executedialog.cpp \
+    tdriver_filewatcher.cpp \
     flowlayout.cpp
 
 HEADERS += libtdriverutil_global.h \
@@ -53,6 +54,7 @@ HEADERS += libtdriverutil_global.h \
     tdriver_rbiprotocol.h \
     tdriver_debug_macros.h \
     tdriver_executedialog.h \
+    tdriver_filewatcher.h \
     flowlayout.h
 
 FORMS += \
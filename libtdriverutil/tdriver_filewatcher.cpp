@@ -0,0 +1,182 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#include "tdriver_filewatcher.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QTimer>
+
+#include "tdriver_debug_macros.h"
+
+
+// events arriving within this time are handled as one batch
+static const int batchInterval = 200;
+
+// content of larger files is not hashed, size and modification time are used instead
+static const qint64 maxHashedSize = 8*1024*1024;
+
+
+TDriverFileWatcher *TDriverFileWatcher::pGlobalInstance = NULL;
+
+
+TDriverFileWatcher *TDriverFileWatcher::globalInstance()
+{
+    if (!pGlobalInstance) pGlobalInstance = new TDriverFileWatcher(QCoreApplication::instance());
+    return pGlobalInstance;
+}
+
+
+TDriverFileWatcher::TDriverFileWatcher(QObject *parent) :
+    QObject(parent),
+    fsWatcher(new QFileSystemWatcher(this)),
+    batchTimer(new QTimer(this))
+{
+    batchTimer->setSingleShot(true);
+    batchTimer->setInterval(batchInterval);
+
+    connect(fsWatcher, SIGNAL(fileChanged(QString)), SLOT(pathChanged(QString)));
+    connect(fsWatcher, SIGNAL(directoryChanged(QString)), SLOT(pathChanged(QString)));
+    connect(batchTimer, SIGNAL(timeout()), SLOT(dispatchChanges()));
+}
+
+
+QByteArray TDriverFileWatcher::contentHash(const QString &path)
+{
+    QFileInfo info(path);
+    if (!info.exists()) return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+
+    if (info.isDir()) {
+        // directory listing changes when entries are added, removed or modified
+        foreach (const QFileInfo &entry, QDir(path).entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden, QDir::Name)) {
+            hash.addData(entry.fileName().toUtf8());
+            hash.addData(QByteArray::number(entry.size()));
+            hash.addData(QByteArray::number(entry.lastModified().toMSecsSinceEpoch()));
+        }
+    }
+    else if (info.size() > maxHashedSize) {
+        hash.addData(QByteArray::number(info.size()));
+        hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    }
+    else {
+        QFile file(path);
+        if (!file.open(QFile::ReadOnly)) return QByteArray();
+        hash.addData(&file);
+    }
+
+    // prefix makes empty file differ from missing file
+    return "h" + hash.result();
+}
+
+
+void TDriverFileWatcher::watch(const QString &path, QObject *client)
+{
+    if (path.isEmpty() || !client) return;
+
+    if (!clientPaths.contains(client)) {
+        connect(client, SIGNAL(destroyed(QObject*)), SLOT(clientDestroyed(QObject*)));
+    }
+    clientPaths[client].insert(path);
+
+    QHash<QObject*, QByteArray> &clients = pathClients[path];
+    if (clients.isEmpty() && QFileInfo(path).exists()) fsWatcher->addPath(path);
+
+    // other clients still get notified of changes they have not seen
+    clients.insert(client, contentHash(path));
+}
+
+
+void TDriverFileWatcher::unwatch(const QString &path, QObject *client)
+{
+    if (!clientPaths.contains(client)) return;
+
+    QSet<QString> &paths = clientPaths[client];
+    paths.remove(path);
+    if (paths.isEmpty()) {
+        disconnect(client, SIGNAL(destroyed(QObject*)), this, SLOT(clientDestroyed(QObject*)));
+        clientPaths.remove(client);
+    }
+
+    if (!pathClients.contains(path)) return;
+
+    QHash<QObject*, QByteArray> &clients = pathClients[path];
+    clients.remove(client);
+    if (clients.isEmpty()) {
+        pathClients.remove(path);
+        pendingPaths.remove(path);
+        fsWatcher->removePath(path);
+    }
+}
+
+
+void TDriverFileWatcher::clientDestroyed(QObject *client)
+{
+    foreach (const QString &path, clientPaths.value(client)) {
+        unwatch(path, client);
+    }
+    clientPaths.remove(client);
+}
+
+
+void TDriverFileWatcher::pathChanged(const QString &path)
+{
+    pendingPaths.insert(path);
+    if (!batchTimer->isActive()) batchTimer->start();
+}
+
+
+void TDriverFileWatcher::dispatchChanges()
+{
+    QHash<QObject*, QStringList> changes;
+
+    foreach (const QString &path, pendingPaths) {
+        if (!pathClients.contains(path)) continue;
+
+        // files replaced by rename or re-created are dropped from watcher, so add them again
+        if (QFileInfo(path).exists() && !fsWatcher->files().contains(path) && !fsWatcher->directories().contains(path)) {
+            fsWatcher->addPath(path);
+        }
+
+        const QByteArray hash(contentHash(path));
+        QHash<QObject*, QByteArray> &clients = pathClients[path];
+
+        for (QHash<QObject*, QByteArray>::iterator it = clients.begin(); it != clients.end(); ++it) {
+            if (it.value() == hash) continue; // touched, but content is same
+            it.value() = hash;
+            changes[it.key()] << path;
+        }
+    }
+    pendingPaths.clear();
+
+    qDebug() << FCFL << "clients with changes:" << changes.size();
+
+    QHash<QObject*, QStringList>::const_iterator it;
+    for (it = changes.constBegin(); it != changes.constEnd(); ++it) {
+        // client may unwatch or be deleted by handling of earlier signal
+        if (clientPaths.contains(it.key())) emit filesChanged(it.key(), it.value());
+    }
+}
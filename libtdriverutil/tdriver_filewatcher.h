@@ -0,0 +1,75 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#ifndef TDRIVER_FILEWATCHER_H
+#define TDRIVER_FILEWATCHER_H
+
+#include "libtdriverutil_global.h"
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QByteArray>
+
+class QFileSystemWatcher;
+class QTimer;
+
+
+// Shared file system watcher for files and directories shown in the UI.
+// Change notifications are collected for a short interval, paths whose content
+// did not really change since the client started watching them or was last
+// notified are dropped, and then each client gets one filesChanged signal with
+// all of its changed paths.
+class LIBTDRIVERUTILSHARED_EXPORT TDriverFileWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    static TDriverFileWatcher *globalInstance();
+
+    // same path may be watched by many clients, client is unregistered when destroyed.
+    // Watching again takes current content as unchanged for the client, for example after it saved the file.
+    void watch(const QString &path, QObject *client);
+    void unwatch(const QString &path, QObject *client);
+
+signals:
+    void filesChanged(QObject *client, QStringList paths);
+
+private slots:
+    void pathChanged(const QString &path);
+    void dispatchChanges();
+    void clientDestroyed(QObject *client);
+
+private:
+    explicit TDriverFileWatcher(QObject *parent = 0);
+    static QByteArray contentHash(const QString &path);
+
+    QFileSystemWatcher *fsWatcher;
+    QTimer *batchTimer;
+
+    // content hash last seen by each client of path
+    QHash<QString, QHash<QObject*, QByteArray> > pathClients;
+    QHash<QObject*, QSet<QString> > clientPaths;
+    QSet<QString> pendingPaths;
+
+    static TDriverFileWatcher *pGlobalInstance;
+};
+
+#endif // TDRIVER_FILEWATCHER_H
@@ -52,6 +52,7 @@ $lg.debug " ==================================== OPEN"
 
 
 require 'benchmark'
+require 'digest/md5'
 require 'socket'
 
 
@@ -691,6 +692,29 @@ class ListenerObject
   end
 
 
+  # gets ui dump, but writes it to file only if its digest differs from previous_digest,
+  # dateTime attribute changes in every dump so it is left out of the digest
+  def watch_ui( sut, sut_id, previous_digest, app_id = nil )
+    MobyUtil::Parameter[ sut.id ][ :filter_type] = 'none'
+    MobyUtil::Parameter[ sut.id ][ :use_find_object] = 'false'
+
+    data = sut.get_ui_dump( *[ ( { :id => app_id } unless app_id.nil? ) ].compact ).to_s
+    digest = Digest::MD5.hexdigest( data.gsub( /dateTime="[^"]*"/, '' ) )
+    @listener_reply['ui_digest'] = [ digest ]
+    return if digest == previous_digest
+
+    filename_xml, file_xml = create_output_file(@working_directory, "visualizer_dump_#{ sut_id }", 'xml' )
+    begin
+      file_xml << data
+    ensure
+      file_xml.close
+    end
+
+    $lg.debug this_method + " wrote #{File.size?(filename_xml)/1024.0} KiB to '#{filename_xml}'"
+    @listener_reply['ui_filename'] = [ filename_xml ]
+  end
+
+
   def capture_screen( sut, sut_id, app_id = nil )
     filename_png, file_png = create_output_file(@working_directory, "visualizer_dump_#{ sut_id }", 'png' )
     begin
@@ -792,6 +816,34 @@ class ListenerObject
     @listener_reply['output_path'] = [ @working_directory.to_s ]
   end
 
+  # executes operations of a batch message ( batch_0 .. batch_N-1 ), continuing after failed ones,
+  # and replies with 'ok' or error message for each operation
+  def run_batch( sut, msg )
+    results = []
+    count = ( msg[ 'batch_count' ] || [] ).first.to_i
+    count.times do | index |
+      op = msg[ "batch_#{ index }" ] || []
+      begin
+        case op[ 0 ].to_s
+        when 'set_attribute'
+          # object ruby id, data type, attribute name, value
+          eval( "sut.application.#{ op[ 1 ] }" ).set_attribute( op[ 3 ].to_s, op[ 4 ].to_s, op[ 2 ].to_s )
+        when 'tap'
+          # object ruby id, optional application id
+          app = ( op.size > 2 ) ? sut.application( :id => op[ 2 ].to_s ) : sut.application
+          eval( "app.#{ op[ 1 ] }" ).tap
+        else
+          raise ArgumentError, "unknown batch operation (#{ op[ 0 ] })"
+        end
+        results << 'ok'
+      rescue => ex
+        $lg.error this_method + " batch operation #{ index } failed #{ ex.class }: #{ ex.message }"
+        results << "#{ ex.class }: #{ ex.message }"
+      end
+    end
+    @listener_reply[ 'batch_results' ] = results
+  end
+
   def main_loop (conn)
     recorder = nil
     interact = Code_evaluation_sandbox.new
@@ -863,6 +915,9 @@ class ListenerObject
             when :refresh_ui
               eval_cmd = "get_ui_dump( sut, '#{ sut_id.to_s }', #{ input_array.size > 2 ? "'#{ input_array[2] }'" : "nil" } )"
 
+            when :watch_ui
+              eval_cmd = "watch_ui( sut, '#{ sut_id.to_s }', '#{ input_array[2] }', #{ input_array.size > 3 ? "'#{ input_array[3] }'" : "nil" } )"
+
             when :refresh_image
               eval_cmd = "capture_screen( sut, '#{ sut_id.to_s }', #{ input_array.size > 2 ? "'#{ input_array[2] }'" : "nil" } )"
 
@@ -913,6 +968,9 @@ class ListenerObject
             when :test_record
               eval_cmd = "test_script(sut, '#{ input_array[2]}' )"
 
+            when :batch
+              eval_cmd = "run_batch( sut, msgIn )"
+
             when :start_application
               eval_cmd = "sut.run(:name=>'#{input_array[2]}', :arguments=>'#{input_array[3]}' )"
 
@@ -0,0 +1,129 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#include "tdriver_main_window.h"
+
+#include "tdriver_debug_macros.h"
+
+
+// Returns true if operation was queued, false if batch mode is off and caller should send it.
+bool MainWindow::queueBatchOperation(const QStringList &operation, const QString &description)
+{
+    if (!batchModeAction->isChecked()) return false;
+
+    batchOperations << operation;
+    batchDescriptions << description;
+    updateBatchActions();
+    statusbar(tr("Queued %1, %2 operations in batch").arg(description).arg(batchOperations.size()), 2000);
+    return true;
+}
+
+
+void MainWindow::discardBatch()
+{
+    batchOperations.clear();
+    batchDescriptions.clear();
+    updateBatchActions();
+}
+
+
+void MainWindow::updateBatchActions()
+{
+    batchSendAction->setEnabled(!batchOperations.isEmpty());
+    batchSendAction->setText(batchOperations.isEmpty()
+                             ? tr("Send Batc&h")
+                             : tr("Send Batc&h (%1)").arg(batchOperations.size()));
+}
+
+
+void MainWindow::toggleBatchMode(bool enabled)
+{
+    if (enabled || batchOperations.isEmpty()) return;
+
+    QMessageBox::StandardButton answer = QMessageBox::question(
+                this,
+                tr("Batch Mode"),
+                tr("Send %1 queued operations now?").arg(batchOperations.size()),
+                QMessageBox::Yes | QMessageBox::Discard,
+                QMessageBox::Yes);
+
+    if (answer == QMessageBox::Yes) {
+        sendBatch();
+    }
+    else {
+        discardBatch();
+    }
+}
+
+
+// Sends all queued operations in one message:
+// input => [device, "batch"], batch_count => [N], batch_0 .. batch_N-1 => operation arguments
+void MainWindow::sendBatch()
+{
+    if (batchOperations.isEmpty()) return;
+
+    if (!isDeviceSelected()) {
+        noDeviceSelectedPopup();
+        return;
+    }
+
+    BAListMap msg;
+    msg["input"] << activeDevice.toLatin1() << "batch";
+    msg["batch_count"] << QByteArray::number(batchOperations.size());
+    for (int ii = 0; ii < batchOperations.size(); ++ii) {
+        msg["batch_" + QByteArray::number(ii)] = TDriverUtil::toBAList(batchOperations.at(ii));
+    }
+
+    if (sendTDriverCommand(commandBatch, msg, tr("batch"), QString::number(batchOperations.size()))) {
+        propertiesDock->setDisabled(true);
+        statusbar(tr("Batch of %1 operations sent...").arg(batchOperations.size()));
+        // descriptions are kept for reporting results, new operations may be queued meanwhile
+        batchSentDescriptions = batchDescriptions;
+        discardBatch();
+    }
+    else {
+        QMessageBox::critical(this, tr("Batch Error"), tr("Failed to send batch operations!"));
+    }
+}
+
+
+// Reports failed operations and refreshes once for whole batch.
+void MainWindow::handleBatchReply(const BAListMap &reply)
+{
+    const BAList &results = reply.value("batch_results");
+    QStringList failures;
+
+    for (int ii = 0; ii < results.size(); ++ii) {
+        if (results.at(ii) != "ok") {
+            failures << tr("%1: %2").arg(batchSentDescriptions.value(ii, QString::number(ii)),
+                                         QString::fromUtf8(results.at(ii)));
+        }
+    }
+    batchSentDescriptions.clear();
+
+    if (!failures.isEmpty()) {
+        tdriverMsgAppend(tr("%1 of %2 batch operations failed:\n\n").arg(failures.size()).arg(results.size())
+                         + failures.join("\n"));
+    }
+
+    statusbar(tr("Batch done, auto-refreshing..."), 1000);
+    startRefreshSequence();
+}
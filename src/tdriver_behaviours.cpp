@@ -21,6 +21,8 @@
 
 #include "tdriver_behaviour.h"
 
+#include <algorithm>
+
 // constructor
 Behaviour::Behaviour() {
 
@@ -64,26 +66,41 @@ QStringList Behaviour::getControlMethods() {
 
 }
 
-void Behaviour::addMethod(QString methodName, QMap<QString, QString> methodHash ) {
+static bool methodNameLessThan( const BehaviourMethod &method, const QString &name ) {
 
-    if ( !methods.contains( methodName ) ) { methods.insert( methodName, methodHash ); }
+    return method.name < name;
 
 }
 
-QMap<QString, QString> Behaviour::getMethod( QString methodName ) {
+void Behaviour::addMethod( const BehaviourMethod &method ) {
+
+    QVector<BehaviourMethod>::iterator pos = std::lower_bound( methods.begin(), methods.end(), method.name, methodNameLessThan );
+
+    if ( pos == methods.end() || pos->name != method.name ) { methods.insert( pos, method ); }
+
+}
 
-    QMap<QString, QString> result;
 
-    if ( methods.contains( methodName ) ) { result = methods.value( methodName ); }
+QDataStream &operator<<(QDataStream &out, const BehaviourMethod &method) {
 
-    return result;
+    return out << method.name << method.description << method.example;
 
 }
 
-QStringList Behaviour::getMethodsList() {
+QDataStream &operator>>(QDataStream &in, BehaviourMethod &method) {
 
-    return methods.keys();
+    return in >> method.name >> method.description >> method.example;
 
 }
 
+QDataStream &operator<<(QDataStream &out, const Behaviour &behaviour) {
+
+    return out << behaviour.sutTypes << behaviour.controlMethods << behaviour.methods;
 
+}
+
+QDataStream &operator>>(QDataStream &in, Behaviour &behaviour) {
+
+    return in >> behaviour.sutTypes >> behaviour.controlMethods >> behaviour.methods;
+
+}
@@ -0,0 +1,113 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#include "tdriver_main_window.h"
+#include "tdriver_image_view.h"
+#include "tdriver_findallpanel.h"
+
+#include "tdriver_debug_macros.h"
+
+
+// Moves current snapshot, tree items included, to a stored session of device.
+// Caller is expected to clear the now empty views.
+void MainWindow::storeDeviceSession(const QString &device)
+{
+    DeviceSession session;
+
+    session.currentItem = ptr2TestObjectKey(objectTree->currentItem());
+    session.treeItems = objectTree->invisibleRootItem()->takeChildren();
+
+    session.attributes.swap(attributesMap);
+    session.geometries.swap(geometriesMap);
+    session.screenshotObjects.swap(screenshotObjects);
+    session.treeData.swap(objectTreeData);
+    session.idMap.swap(objectIdMap);
+    session.objectItems.swap(objectItems);
+    session.objectIndex = objectIndex;
+    session.locatorAnalyzer = locatorAnalyzer;
+
+    session.applicationsNames = applicationsNamesMap;
+    session.currentApplication = currentApplication;
+    session.uiDumpFileName = uiDumpFileName;
+    session.imageFileName = imageWidget->lastImageFileName();
+    session.watchDigest = watchDigest;
+    session.batchOperations = batchOperations;
+    session.batchDescriptions = batchDescriptions;
+
+    // replaced session was restored earlier, so it owns no tree items
+    deviceSessions.insert(device, session);
+    qDebug() << FCFL << "stored" << session.treeItems.size() << "top level items of" << device;
+}
+
+
+bool MainWindow::restoreDeviceSession(const QString &device)
+{
+    if (!deviceSessions.contains(device)) return false;
+
+    DeviceSession session(deviceSessions.take(device));
+
+    attributesMap.swap(session.attributes);
+    geometriesMap.swap(session.geometries);
+    screenshotObjects.swap(session.screenshotObjects);
+    objectTreeData.swap(session.treeData);
+    objectIdMap.swap(session.idMap);
+    objectItems.swap(session.objectItems);
+    objectIndex = session.objectIndex;
+    locatorAnalyzer = session.locatorAnalyzer;
+    findAllPanel->setIndex(objectIndex);
+
+    applicationsNamesMap = session.applicationsNames;
+    currentApplication = session.currentApplication;
+    updateApplicationsList();
+
+    uiDumpFileName = session.uiDumpFileName;
+    if (!session.imageFileName.isEmpty()) {
+        imageWidget->refreshImage(session.imageFileName);
+    }
+
+    watchDigest = session.watchDigest;
+    batchOperations = session.batchOperations;
+    batchDescriptions = session.batchDescriptions;
+    updateBatchActions();
+
+    objectTree->invisibleRootItem()->addChildren(session.treeItems);
+    if (session.currentItem) {
+        objectTree->setCurrentItem(objectItem(session.currentItem));
+    }
+
+    qDebug() << FCFL << "restored" << session.treeItems.size() << "top level items of" << device;
+    return true;
+}
+
+
+// Replies which would replace shown snapshot must be for active device.
+bool MainWindow::isReplyForOtherDevice(const SentTDriverMsg &sentMsg) const
+{
+    switch (sentMsg.type) {
+    case commandListApps:
+    case commandRefreshUI:
+    case commandRefreshImage:
+    case commandWatchUi:
+        return sentMsg.msg.value("input").value(0) != activeDevice.toLatin1();
+    default:
+        return false;
+    }
+}
@@ -20,52 +20,25 @@
 
 #include <tdriver_combolineedit.h>
 #include "tdriver_main_window.h"
+#include "tdriver_objectindex.h"
+#include "tdriver_findallpanel.h"
+#include "tdriver_locatoranalyzer.h"
 #include <tdriver_debug_macros.h>
 
 #include <QGridLayout>
 #include <QShortcut>
 
-bool MainWindow::containsWords( const TreeItemInfo &itemData, QString text, bool caseSensitive, bool entireWords )
+void MainWindow::rebuildObjectIndex()
 {
-    bool result = false;
-    Qt::CaseSensitivity caseSensitivity = caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
-
-    if ( entireWords ) {
-        result = (
-            itemData.name.compare( text, caseSensitivity ) == 0 ||
-            itemData.type.compare( text, caseSensitivity ) == 0 ||
-            itemData.id.compare( text, caseSensitivity ) == 0 );
-    }
-
-    else {
-        result = (
-            itemData.name.contains( text, caseSensitivity ) ||
-            itemData.type.contains( text, caseSensitivity ) ||
-            itemData.id.contains( text, caseSensitivity ));
-    }
-
-    return result;
-}
-
-bool MainWindow::attributeContainsWords( TestObjectKey itemPtr, QString text, bool caseSensitive, bool entireWords )
-{
-    bool result = false;
-
-    Qt::CaseSensitivity caseSensitivity = caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
-    QMapIterator<QString, AttributeInfo > iterator( attributesMap.value( itemPtr ) );
-
-    while ( iterator.hasNext() && !result ) {
-
-        iterator.next();
-        QString value = iterator.value().value;
-
-        if ( entireWords ? ( value.compare( text, caseSensitivity ) == 0 ) : ( value.contains( text, caseSensitivity ) ) ) {
-            result = true;
-            break;
-        }
-    }
-
-    return result;
+    QSharedPointer<TDriverObjectIndex> index(new TDriverObjectIndex);
+    index->build(objectTree->invisibleRootItem(), objectTreeData, attributesMap);
+    objectIndex = index;
+    locatorAnalyzer = QSharedPointer<TDriverLocatorAnalyzer>(new TDriverLocatorAnalyzer(objectIndex));
+    findAllPanel->setIndex(objectIndex);
+
+    // query results refer to previous index
+    objectQueryResults.clear();
+    objectQueryLastText.clear();
 }
 
 
@@ -142,86 +115,30 @@ QTreeWidgetItem *MainWindow::findDialogSubtreeNext(QTreeWidgetItem *current, QTr
 }
 
 
-static inline QTreeWidgetItem *goToBottomChild(QTreeWidgetItem *node)
-{
-    forever {
-        int count = node->childCount();
-        if (count <= 0) return node;
-        node = node->child(count-1);
-    }
-}
-
-
-QTreeWidgetItem *MainWindow::findDialogSubtreePrev(QTreeWidgetItem *current, QTreeWidgetItem *root, bool wrap)
-{
-    if (!current) return NULL; // invalid current item
-
-    Q_ASSERT(current != objectTree->invisibleRootItem());
-
-    if (current == root || current == objectTree->topLevelItem(0)) {
-        if (!wrap) return NULL; // at subtree root, no next
-        else return goToBottomChild(current); // wrap to end of tree
-        // not reached
-    }
-
-    // can't use QTreeWidget::itemAbove because it will not iterate into hidden subtrees
-
-    QTreeWidgetItem *par = current->parent();
-    Q_ASSERT(par && par != objectTree->invisibleRootItem());
-
-    int ind = par->indexOfChild(current);
-    Q_ASSERT(ind >= 0 && ind < par->childCount());
-    if (ind == 0) return par; // no previous sibling, so parent is previous
-    else return goToBottomChild(par->child(ind-1)); // last descendant of previous sibling is previous
-}
-
-
-bool MainWindow::compareTreeItem(QTreeWidgetItem *item, const QString &findString, bool matchCase, bool entireWords, bool searchAttributes)
-{
-    if (!item) return false;
-
-    TestObjectKey itemIndex = ptr2TestObjectKey(item);
-    Q_ASSERT(objectTreeData.contains( itemIndex) );
-
-    // check values in itemData
-    if ( containsWords( objectTreeData.value( itemIndex ), findString, matchCase, entireWords ) ) {
-        return true;
-    }
-
-    // check attribute values if that option is checked
-    if ( searchAttributes ) {
-        if ( attributeContainsWords( itemIndex, findString, matchCase, entireWords ) ) {
-            return true;
-        }
-    }
-
-    return false;
-}
-
-
 void MainWindow::findFromSubTree(QTreeWidgetItem *current, const QString &findString, bool backwards, bool matchCase, bool entireWords, bool searchWrapAround, bool searchAttributes)
 {
     Q_ASSERT(findDialogSubtreeRoot);
-    QTreeWidgetItem *startItem = current;
 
-    forever {
+    if (!objectIndex) rebuildObjectIndex();
 
-        current = backwards ?
-                  findDialogSubtreePrev(current, findDialogSubtreeRoot, searchWrapAround) :
-                  findDialogSubtreeNext(current, findDialogSubtreeRoot, searchWrapAround);
+    TDriverObjectIndex::Query query;
+    query.text = findString;
+    query.matchCase = matchCase;
+    query.entireWords = entireWords;
+    query.searchAttributes = searchAttributes;
 
-        if (compareTreeItem(current, findString, matchCase, entireWords, searchAttributes)) {
-            // found
-            objectTree->setCurrentItem( current );
-            return;
-        }
+    int found = objectIndex->findNext(query,
+                                      objectIndex->ordinal(ptr2TestObjectKey(current)),
+                                      objectIndex->ordinal(ptr2TestObjectKey(findDialogSubtreeRoot)),
+                                      backwards, searchWrapAround);
 
-        if (!current || current == startItem) {
-            QMessageBox::warning(this,
-                                 tr("Find"),
-                                 tr("No matches found with '%1'").arg(findDialogText->currentText()) );
-            return;
-        }
+    if (found >= 0) {
+        objectTree->setCurrentItem(objectItem(objectIndex->key(found)));
+    }
+    else {
+        QMessageBox::warning(this,
+                             tr("Find"),
+                             tr("No matches found with '%1'").arg(findDialogText->currentText()) );
     }
 }
 
@@ -400,3 +317,33 @@ void MainWindow::createFindDialogShortcuts()
     findSC = new QShortcut(QKeySequence("Ctrl+F"), propertiesDock, 0, 0, Qt::WidgetWithChildrenShortcut);
     connect(findSC, SIGNAL(activated()), findAction, SLOT(trigger()));
 }
+
+
+void MainWindow::createFindAllDockWidget()
+{
+    findAllDock = new QDockWidget(tr(" Find All "), this);
+    findAllDock->setObjectName("findall");
+    findAllDock->setFeatures(DOCK_FEATURES_DEFAULT);
+
+    findAllPanel = new TDriverFindAllPanel(findAllDock);
+    findAllPanel->setObjectName("findall");
+    findAllDock->setWidget(findAllPanel);
+
+    connect(findAllPanel, SIGNAL(objectActivated(TestObjectKey)), this, SLOT(findAllObjectActivated(TestObjectKey)));
+}
+
+
+void MainWindow::showFindAll()
+{
+    findAllDock->setVisible(true);
+    findAllDock->raise();
+    findAllPanel->focusSearchText();
+}
+
+
+void MainWindow::findAllObjectActivated(TestObjectKey key)
+{
+    // results may refer to an object tree which has since been replaced
+    if (!objectTreeData.contains(key)) return;
+    highlightByKey(key, true);
+}
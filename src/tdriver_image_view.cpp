@@ -97,6 +97,8 @@ void TDriverImageView::clearImage()
     imageOffset = QPoint();
     imageTasId.clear();
     rects.clear();
+    diffRegions.clear();
+    diffObjects.clear();
     highlightEnabledMode = 0;
 
     if (!scaleImage)
@@ -151,6 +153,26 @@ void TDriverImageView::paintEvent(QPaintEvent *)
         }
     }
 
+    if (!diffRegions.isEmpty() || !diffObjects.isEmpty()) {
+        static const QBrush diffBrush(QColor(255, 0, 255, 96));
+        foreach (const QRect &rect, diffRegions) {
+            painter.fillRect(imageOffset.x() + float(rect.x()) * zoomFactor,
+                             imageOffset.y() + float(rect.y()) * zoomFactor,
+                             float(rect.width()) * zoomFactor,
+                             float(rect.height()) * zoomFactor,
+                             diffBrush);
+        }
+
+        static const QPen diffObjectPen(QBrush(QColor(255, 140, 0)), 2);
+        painter.setPen(diffObjectPen);
+        foreach (const QRect &rect, diffObjects) {
+            painter.drawRect(imageOffset.x() + float(rect.x()) * zoomFactor,
+                             imageOffset.y() + float(rect.y()) * zoomFactor,
+                             float(rect.width()) * zoomFactor,
+                             float(rect.height()) * zoomFactor );
+        }
+    }
+
     if (dragging) {
         //qDebug()  << FCFL << "dragged enough?" << testDragThreshold(dragEnd, dragStart);
         if (testDragThreshold(dragStart, dragEnd)) {
@@ -524,6 +546,8 @@ void TDriverImageView::refreshImage(const QString &imagePath)
 
     imageFileName = (image->isNull()) ? QString() : imagePath;
     imageOffset = QPoint();
+    diffRegions.clear();
+    diffObjects.clear();
 
     if (!scaleImage)
         resize(image->size());
@@ -554,3 +578,18 @@ void TDriverImageView::drawHighlights( RectList geometries, bool multiple )
 }
 
 
+void TDriverImageView::drawDiff( const RectList &regions, const RectList &objects )
+{
+    diffRegions = regions;
+    diffObjects = objects;
+    update();
+}
+
+
+void TDriverImageView::clearDiff()
+{
+    diffRegions.clear();
+    diffObjects.clear();
+    update();
+}
+
@@ -120,6 +120,8 @@ void MainWindow::imageTapFromId(TestObjectKey id)
 void MainWindow::sendTapScreen(const QStringList &target)
 {
     qDebug() << FCFL << target;
+    if (queueBatchOperation(target, tr("tap %1").arg(target.value(1)))) return;
+
     statusbar(tr("Tapping..."));
     typedef QList<QByteArray> QByteArrayList;
 
@@ -161,7 +163,7 @@ void MainWindow::drawHighlight( TestObjectKey itemKey, bool multiple )
         if (screenshotObjects.contains(itemKey)) {
             // collect geometries for item and its childs
             RectList geometries;
-            collectGeometries( testObjectKey2Ptr(itemKey), geometries);
+            collectGeometries( objectItem(itemKey), geometries);
 
             if ( !geometries.isEmpty() ) {
 
@@ -255,7 +257,7 @@ bool MainWindow::highlightByKey( TestObjectKey itemKey, bool selectItem, QString
 
     drawHighlight( itemKey, false );
 
-    QTreeWidgetItem *item = testObjectKey2Ptr(itemKey);
+    QTreeWidgetItem *item = objectItem(itemKey);
 
     // select item from object tree if selectItem is true
     if ( selectItem ) {
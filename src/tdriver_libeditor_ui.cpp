@@ -26,6 +26,7 @@
 #include <tdriver_debugconsole.h>
 #include <tdriver_rubyinteract.h>
 #include <tdriver_editbar.h>
+#include <tdriver_filesearchpanel.h>
 #include <tdriver_editor_common.h>
 
 #include <QDockWidget>
@@ -44,6 +45,8 @@ void MainWindow::createEditorDocks()
     debugDock->setObjectName("editor debugdock");
     irDock = new QDockWidget(tr("RubyInteract Console"));
     irDock->setObjectName("editor irdock");
+    fileSearchDock = new QDockWidget(tr("Search in Files"));
+    fileSearchDock->setObjectName("editor filesearchdock");
 
     tabEditor = new TDriverTabbedEditor(editorDock, this);
     runConsole = new TDriverRunConsole(true, this);
@@ -118,6 +121,7 @@ void MainWindow::createEditorDocks()
     runDock->setWidget(runConsole);
     debugDock->setWidget(debugConsole);
     irDock->setWidget(irConsole);
+    fileSearchDock->setWidget(tabEditor->fileSearchPanel());
 
     //irDock->setFeatures(QDockWidget::DockWidgetFloatable|QDockWidget::DockWidgetMovable);
     tabEditor->connectConsoles(runConsole, runDock, debugConsole, debugDock, irConsole, irDock);
@@ -129,14 +133,17 @@ void MainWindow::setEditorDocksDefaultLayout()
     runDock->setFloating(false);
     debugDock->setFloating(false);
     irDock->setFloating(false);
+    fileSearchDock->setFloating(false);
 
     addDockWidget(Qt::BottomDockWidgetArea, editorDock, Qt::Horizontal);
     addDockWidget(Qt::BottomDockWidgetArea, runDock, Qt::Vertical);
     addDockWidget(Qt::BottomDockWidgetArea, debugDock, Qt::Vertical);
     addDockWidget(Qt::BottomDockWidgetArea, irDock, Qt::Vertical);
+    addDockWidget(Qt::BottomDockWidgetArea, fileSearchDock, Qt::Vertical);
 
     editorDock->setVisible(false);
     debugDock->setVisible(false);
     runDock->setVisible(false);
     irDock->setVisible(false);
+    fileSearchDock->setVisible(false);
 }
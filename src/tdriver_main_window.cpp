@@ -32,12 +32,14 @@
 #include <QErrorMessage>
 #include <QToolBar>
 #include <QToolButton>
+#include <QToolTip>
 
 #include <tdriver_debug_macros.h>
 
 
 MainWindow::MainWindow() :
     QMainWindow(),
+    metadataCacheDirty(false),
     tdriverMsgBox(new QErrorMessage(this)),
     tdriverMsgTotal(0),
     tdriverMsgShown(1),
@@ -45,6 +47,8 @@ MainWindow::MainWindow() :
     keyLastTDriverDir("files/last_tdriver_dir"),
     keyHistoryStateDirCount("files/state_history_count"),
     messageTimeoutTimer(new QTimer(this)),
+    signalPrefetchTimer(new QTimer(this)),
+    watchTimer(new QTimer(this)),
     doRefreshAfterAppList(false),
     historySavingCounter(-1),
     richTextContainerWidget(new QWidget),
@@ -53,6 +57,12 @@ MainWindow::MainWindow() :
     resetMessageSequenceFlags();
     messageTimeoutTimer->setSingleShot(true);
     connect(messageTimeoutTimer, SIGNAL(timeout()), SLOT(messageTimeoutSlot()));
+    signalPrefetchTimer->setSingleShot(true);
+    signalPrefetchTimer->setInterval(300);
+    connect(signalPrefetchTimer, SIGNAL(timeout()), SLOT(sendSignalPrefetch()));
+    watchTimer->setSingleShot(true);
+    watchInterval = WATCH_INTERVAL_MIN;
+    connect(watchTimer, SIGNAL(timeout()), SLOT(sendWatchPoll()));
 
     richTextContainer->setupUi(richTextContainerWidget);
 
@@ -83,6 +93,10 @@ MainWindow::MainWindow() :
 
 MainWindow::~MainWindow()
 {
+    // stored sessions own their tree items
+    foreach (const DeviceSession &session, deviceSessions) {
+        qDeleteAll(session.treeItems);
+    }
     delete richTextContainer;
     delete richTextContainerWidget;
 }
@@ -350,6 +364,10 @@ void MainWindow::restoreDefaultLayout()
     addDockWidget(Qt::RightDockWidgetArea, propertiesDock, Qt::Horizontal);
     propertiesDock->setVisible( true );
 
+    findAllDock->setFloating(false);
+    addDockWidget(Qt::RightDockWidgetArea, findAllDock, Qt::Vertical);
+    findAllDock->setVisible( false );
+
 #if DEVICE_BUTTONS_ENABLED
     addDockWidget(Qt::BottomDockWidgetArea, keyboardCommandsDock, Qt::Vertical);
     keyboardCommandsDock->setVisible( false );
@@ -469,6 +487,8 @@ void MainWindow::closeEvent( QCloseEvent *event )
 
     TDriverRubyInterface::globalInstance()->requestClose();
 
+    saveMetadataCache();
+
     // save tdriver path
     settings.setValue( "files/location", tdriverPath );
 
@@ -521,7 +541,22 @@ void MainWindow::closeEvent( QCloseEvent *event )
 // Event filter, catches F1/HELP key events and processes them
 bool MainWindow::eventFilter(QObject * object, QEvent *event) {
 
-    Q_UNUSED( object );
+    if (event->type() == QEvent::ToolTip && objectTree && object == objectTree->viewport()) {
+
+        QHelpEvent *he = static_cast<QHelpEvent *>(event);
+        QTreeWidgetItem *item = objectTree->itemAt(he->pos());
+        QString tip;
+        if (item) {
+            tip = objectTreeToolTip(item, objectTree->columnAt(he->pos().x()));
+        }
+        if (tip.isEmpty()) {
+            QToolTip::hideText();
+        }
+        else {
+            QToolTip::showText(he->globalPos(), tip, objectTree->viewport());
+        }
+        return true;
+    }
 
     if (event->type() == QEvent::KeyPress) {
 
@@ -656,6 +691,38 @@ void MainWindow::receiveTDriverMessage(quint32 seqNum, QByteArray name, const BA
 
     SentTDriverMsg sentMsg(sentTDriverMsgs.take(seqNum));
 
+    if (isReplyForOtherDevice(sentMsg)) {
+        // view of the device this was for has been stored, next refresh of it fetches again
+        qDebug() << FCFL << "dropping reply for other device:" << sentMsg.msg.value("input").value(0);
+        objectTree->setDisabled(false);
+        propertiesDock->setDisabled(false);
+        imageViewDock->setDisabled(false);
+
+        if (sentMsg.type == commandWatchUi) {
+            // reply handler restarts polling, so do it here for the active device
+            watchDigest.clear();
+            if (watchModeAction->isChecked()) {
+                watchInterval = WATCH_INTERVAL_MIN;
+                watchTimer->start(watchInterval);
+            }
+        }
+        // refresh sequence flags were reset by deviceSelected, and may now belong to the active device
+        return;
+    }
+
+    if (sentMsg.type == commandPrefetchSignalList) {
+        if (sentMsg.msg.value("input").value(0) != activeDevice.toLatin1()) {
+            // metadata cache is already for the new device, and its in flight set was cleared
+            qDebug() << FCFL << "dropping signal prefetch of other device for" << sentMsg.typeStr;
+            if (!signalPrefetchQueue.isEmpty()) signalPrefetchTimer->start();
+            return;
+        }
+        // prefetch is opportunistic, so errors are not reported and do not cause disconnect
+        signalPrefetchReceived(sentMsg.typeStr, reply.contains("error")
+                               ? QString() : QString(reply.value("signal_filename").value(0)));
+        return;
+    }
+
     bool handleError = false;
     bool handleNormally = false;
 
@@ -735,6 +802,7 @@ void MainWindow::receiveTDriverMessage(quint32 seqNum, QByteArray name, const BA
                 statusbar(tr("Could not send behaviour update!"), 2000);
                 propertiesDock->setDisabled(false);
             }
+            scheduleSignalPrefetch();
         }
         else {
             // re-enable if not normal handling above
@@ -801,6 +869,7 @@ void MainWindow::receiveTDriverMessage(quint32 seqNum, QByteArray name, const BA
         if (handleNormally) {
             statusbar(tr("Api methods received"), 2000);
             parseApiMethodsXml( reply.value("fixture_filename").value(0));
+            metadataCacheDirty = true;
 
             if (apiMethodsMap.contains( sentMsg.typeStr )) {
                 // call updateApiTableContent() only if parseApiMethodsXml is of correct object,
@@ -819,13 +888,13 @@ void MainWindow::receiveTDriverMessage(quint32 seqNum, QByteArray name, const BA
     case commandBehavioursXml:
         if (handleNormally) {
             statusbar(tr("Behaviours received"), 2000);
-            if (parseXml( reply.value("behaviour_filename").value(0) , behaviorDomDocument )) {
-                buildBehavioursMap();
+            if (buildBehavioursMap( reply.value("behaviour_filename").value(0) )) {
+                metadataCacheDirty = true;
                 doPropertiesTableUpdate();
                 // todo: handle properties dock disabling better
                 propertiesDock->setDisabled(false);
             }
-            else qDebug() << FCFL << "parseXml fail";
+            else qDebug() << FCFL << "buildBehavioursMap fail";
         }
         break;
 
@@ -840,21 +909,8 @@ void MainWindow::receiveTDriverMessage(quint32 seqNum, QByteArray name, const BA
             if (!fileName.isEmpty()) {
                 const QStringList signalsList = parseSignalsXml( fileName );
                 apiSignalsMap[sentMsg.typeStr] = signalsList;
-
-                foreach(const QString &signalName, signalsList) {
-                    // add signal name
-                    QTableWidgetItem *signalItem = new QTableWidgetItem( signalName );
-                    signalItem->setFlags( Qt::ItemIsSelectable | Qt::ItemIsEnabled );
-                    signalItem->setFont( *defaultFont );
-
-                    // append new line to table
-                    int rowNumber = signalsTable->rowCount();
-                    signalsTable->insertRow( rowNumber );
-                    signalsTable->setItem( rowNumber, 0, signalItem );
-                }
-                // sort signals table
-                signalsTable->sortItems( 0 );
-                signalsTable->resizeColumnToContents (0);
+                metadataCacheDirty = true;
+                fillSignalsTable( signalsList );
 
                 statusbar(tr("Signal list received."), 2000);
             }
@@ -866,6 +922,10 @@ void MainWindow::receiveTDriverMessage(quint32 seqNum, QByteArray name, const BA
         }
         break;
 
+    case commandPrefetchSignalList:
+        // handled before error processing above
+        break;
+
     case commandGetDeviceParameter:
         break;
 
@@ -875,6 +935,27 @@ void MainWindow::receiveTDriverMessage(quint32 seqNum, QByteArray name, const BA
     case commandStartApplication:
         break;
 
+    case commandBatch:
+        if (handleNormally) {
+            handleBatchReply(reply);
+        }
+        else {
+            // descriptions of the failed batch must not label results of the next one
+            batchSentDescriptions.clear();
+            propertiesDock->setDisabled(false);
+        }
+        break;
+
+    case commandWatchUi:
+        if (handleNormally) {
+            handleWatchReply(reply);
+        }
+        else {
+            // polling an unreachable SUT would only repeat the error
+            watchModeAction->setChecked(false);
+        }
+        break;
+
     case commandRecordingStart:
         break;
 
@@ -901,6 +982,8 @@ void MainWindow::messageTimeoutSlot()
 {
     statusbar(tr("cuTeDriver interface time-out!"), 1000);
     resetMessageSequenceFlags();
+    // late replies are still stored, but do not block new prefetches
+    signalPrefetchInFlight.clear();
 }
 
 
@@ -939,6 +1022,8 @@ void MainWindow::processErrorMessage(ExecuteCommandType commandType, const QStri
         case commandRefreshImage: clearError = tr("Failed to refresh screen capture image."); break;
         case commandKeyPress: clearError = tr("Failed to press key %1.").arg(additionalInformation); break;
         case commandSetAttribute: clearError = tr("Failed to set attribute %1.").arg(additionalInformation); break;
+        case commandBatch: clearError = tr("Failed to execute batch operations."); break;
+        case commandWatchUi: clearError = tr("Failed to poll UI changes, watch mode stopped."); break;
         case commandGetVersionNumber: clearError = tr("Failed to retrieve cuTeDriver version number."); break;
         case commandStartApplication: clearError = tr("Failed to start application."); break;
         default: clearError = tr("Error with command string '%1'").arg(commandString);
@@ -1016,6 +1101,15 @@ bool MainWindow::sendTDriverCommand( ExecuteCommandType commandType,
     BAListMap msg;
     msg["input"] = TDriverUtil::toBAList(inputList);
 
+    return sendTDriverCommand(commandType, msg, errorName, typeStr);
+}
+
+
+bool MainWindow::sendTDriverCommand( ExecuteCommandType commandType,
+                                     const BAListMap &msg,
+                                     const QString &errorName,
+                                     const QString &typeStr)
+{
     quint32 seqNum = TDriverRubyInterface::globalInstance()->sendCmd(TDriverUtil::visualizationId, msg);
 
     qDebug() << FCFL << "SENT SEQNUM" << seqNum;
@@ -1221,6 +1315,26 @@ void MainWindow::createActions()
 
     connect( delayedRefreshAction, SIGNAL(triggered()), this, SLOT(delayedRefreshData()));
 
+    batchModeAction = new QAction(tr("&Batch Mode"), this );
+    batchModeAction->setObjectName("main batchmode");
+    batchModeAction->setCheckable( true );
+
+    connect( batchModeAction, SIGNAL(toggled(bool)), this, SLOT(toggleBatchMode(bool)));
+
+    batchSendAction = new QAction(tr("Send Batc&h"), this );
+    batchSendAction->setObjectName("main batchsend");
+    batchSendAction->setShortcut(QKeySequence(tr("Ctrl+Alt+B")));
+    batchSendAction->setDisabled( true );
+
+    connect( batchSendAction, SIGNAL(triggered()), this, SLOT(sendBatch()));
+
+    watchModeAction = new QAction(tr("&Watch Mode"), this );
+    watchModeAction->setObjectName("main watchmode");
+    watchModeAction->setCheckable( true );
+    watchModeAction->setShortcut(QKeySequence(tr("Ctrl+Alt+W")));
+
+    connect( watchModeAction, SIGNAL(toggled(bool)), this, SLOT(toggleWatchMode(bool)));
+
     sutDisconnectAction = new QAction( tr( "Dis&connect SUT" ), this );
     sutDisconnectAction->setObjectName("main disconnectsut");
     sutDisconnectAction->setShortcuts(QList<QKeySequence>() <<
@@ -1242,6 +1356,12 @@ void MainWindow::createActions()
 
     connect( findAction, SIGNAL( triggered() ), this, SLOT( showFindDialog() ) );
 
+    findAllAction = new QAction(tr("Find &All"), this);
+    findAllAction->setObjectName("main findall");
+    findAllAction->setShortcut( QKeySequence(tr("Ctrl+Shift+F")));
+
+    connect( findAllAction, SIGNAL( triggered() ), this, SLOT( showFindAll() ) );
+
     startAppAction = new QAction(tr("Start New Application"), this);
     startAppAction->setObjectName("main startapp");
 
@@ -83,6 +83,11 @@ void MainWindow::createFileMenu() {
 
     fileMenu->addAction( refreshAction );
     fileMenu->addAction( delayedRefreshAction );
+    fileMenu->addAction( watchModeAction );
+
+    // batch mode
+    fileMenu->addAction( batchModeAction );
+    fileMenu->addAction( batchSendAction );
 
     // tap and auto-refresh on Image View click
     //note:  action constructed in MainWindow::createImageViewDockWidget()
@@ -107,6 +112,7 @@ void MainWindow::createSearchMenu() {
     // dockable widget menu: clipboard
 
     searchMenu->addAction( findAction );
+    searchMenu->addAction( findAllAction );
 
     menubar->addMenu( searchMenu )->setObjectName("main search");
 
@@ -510,6 +516,17 @@ void MainWindow::deviceSelected()
 
         if ( strOldDevice != activeDevice) {
 
+            if ( !strOldDevice.isEmpty() ) {
+                // keep snapshot of previous device, takes object tree items out of the tree
+                storeDeviceSession( strOldDevice );
+            }
+
+            // queued operations target previous device
+            discardBatch();
+            watchDigest.clear();
+            signalPrefetchInFlight.clear();
+            signalPrefetchFailed.clear();
+
             // clear applications
             resetMessageSequenceFlags();
             resetApplicationsList();
@@ -530,6 +547,9 @@ void MainWindow::deviceSelected()
             // empty properties table
             clearPropertiesTableContents();
 
+            if ( restoreDeviceSession( activeDevice ) ) {
+                statusbar( tr( "Showing stored state of %1" ).arg( activeDevice ), 2000 );
+            }
         }
     }
 
@@ -558,7 +578,7 @@ void MainWindow::deviceSelected()
     }
     // update window title
     updateWindowTitle();
-    behavioursMap.clear();
+    resetMetadataCache();
     propertyTabLastTimeUpdated.clear();
 }
 
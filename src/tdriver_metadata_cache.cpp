@@ -0,0 +1,110 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#include "tdriver_main_window.h"
+#include "tdriver_metadatacache.h"
+
+#include <tdriver_rubyinterface.h>
+
+#include "tdriver_debug_macros.h"
+
+
+// Loads cached metadata for current cuTeDriver version and SUT type, once they are known.
+// Entries already fetched in this session take precedence over cached ones.
+void MainWindow::syncMetadataCache()
+{
+    QString fileName(TDriverMetadataCache::fileName(
+                         TDriverRubyInterface::globalInstance()->getTDriverVersion(),
+                         activeDeviceParams.value("type")));
+
+    if (fileName == metadataCacheFile) return;
+
+    if (!metadataCacheFile.isEmpty()) {
+        // cache key changed within a session, old data does not apply any more
+        saveMetadataCache();
+        behavioursMap.clear();
+        apiSignalsMap.clear();
+        apiMethodsMap.clear();
+    }
+    metadataCacheFile = fileName;
+    if (fileName.isEmpty()) return;
+
+    TDriverMetadataCache::BehaviourMap cachedBehaviours;
+    TDriverMetadataCache::SignalMap cachedSignals;
+    TDriverMetadataCache::ApiMethodMap cachedApiMethods;
+
+    if (!TDriverMetadataCache::read(fileName, cachedBehaviours, cachedSignals, cachedApiMethods)) {
+        return;
+    }
+
+    QMapIterator<QString, Behaviour> behaviourIter(cachedBehaviours);
+    while (behaviourIter.hasNext()) {
+        behaviourIter.next();
+        if (!behavioursMap.contains(behaviourIter.key())) {
+            behavioursMap.insert(behaviourIter.key(), behaviourIter.value());
+        }
+    }
+
+    QHashIterator<QString, QStringList> signalIter(cachedSignals);
+    while (signalIter.hasNext()) {
+        signalIter.next();
+        if (!apiSignalsMap.contains(signalIter.key())) {
+            apiSignalsMap.insert(signalIter.key(), signalIter.value());
+        }
+    }
+
+    QHashIterator<QString, QMap<QString, QHash<QString, QString> > > apiIter(cachedApiMethods);
+    while (apiIter.hasNext()) {
+        apiIter.next();
+        if (!apiMethodsMap.contains(apiIter.key())) {
+            apiMethodsMap.insert(apiIter.key(), apiIter.value());
+        }
+    }
+}
+
+
+// Called when SUT changes: stores data of previous SUT and starts over.
+void MainWindow::resetMetadataCache()
+{
+    saveMetadataCache();
+
+    behavioursMap.clear();
+    apiSignalsMap.clear();
+    apiMethodsMap.clear();
+    metadataCacheFile.clear();
+    metadataCacheDirty = false;
+    signalPrefetchFailed.clear();
+
+    syncMetadataCache();
+}
+
+
+void MainWindow::saveMetadataCache()
+{
+    if (!metadataCacheDirty || metadataCacheFile.isEmpty()) return;
+
+    if (TDriverMetadataCache::write(metadataCacheFile, behavioursMap, apiSignalsMap, apiMethodsMap)) {
+        metadataCacheDirty = false;
+    }
+    else {
+        qDebug() << FCFL << "failed to save" << metadataCacheFile;
+    }
+}
@@ -0,0 +1,64 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#include "tdriver_main_window.h"
+#include "tdriver_objectindex.h"
+#include "tdriver_objectquery.h"
+#include "tdriver_debug_macros.h"
+
+#include <QElapsedTimer>
+
+
+void MainWindow::runObjectQuery()
+{
+    QString queryText = objectQueryEdit->text().trimmed();
+    if (queryText.isEmpty()) return;
+
+    if (!objectIndex) rebuildObjectIndex();
+
+    // repeated Enter with same query steps through the results
+    if (queryText != objectQueryLastText || objectQueryResults.isEmpty()) {
+        TDriverObjectQuery query;
+        if (!query.parse(queryText)) {
+            statusbar(tr("Invalid query: %1").arg(query.errorString()), 5000);
+            return;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        objectQueryResults = query.evaluate(*objectIndex);
+        qDebug() << FCFL << queryText << "matched" << objectQueryResults.size()
+                 << "of" << objectIndex->count() << "objects in" << timer.elapsed() << "ms";
+
+        objectQueryLastText = queryText;
+        objectQueryPosition = -1;
+    }
+
+    if (objectQueryResults.isEmpty()) {
+        statusbar(tr("No objects match the query"), 5000);
+        return;
+    }
+
+    objectQueryPosition = (objectQueryPosition + 1) % objectQueryResults.size();
+    highlightByKey(objectIndex->key(objectQueryResults.at(objectQueryPosition)), true);
+    statusbar(tr("Query match %1 of %2").arg(objectQueryPosition + 1).arg(objectQueryResults.size()), 5000);
+}
+
@@ -19,6 +19,9 @@
 
 #include "tdriver_main_window.h"
 #include "tdriver_image_view.h"
+#include "tdriver_objectindex.h"
+#include "tdriver_locatoranalyzer.h"
+#include "tdriver_objecttreedelegate.h"
 #include <tdriver_util.h>
 
 #include <tdriver_debug_macros.h>
@@ -33,7 +36,7 @@ bool MainWindow::getItemPos(QTreeWidgetItem *item, int &x, int &y)
 {
     const TestObjectKey itemKey = ptr2TestObjectKey(item);
 
-    const QMap<QString, AttributeInfo > &attributes = attributesMap[itemKey];
+    const QMap<QString, AttributeInfo > &attributes = attributesMap.value(itemKey);
 
     QPoint ret;
 
@@ -99,7 +102,7 @@ void MainWindow::collectGeometries( QTreeWidgetItem * item, RectList & geometrie
             }
 
             // retrieve selected items attributes
-            const QMap<QString, AttributeInfo > &attributes = attributesMap[itemPtr];
+            const QMap<QString, AttributeInfo > &attributes = attributesMap.value(itemPtr);
 
             // retrieve x, y, widht height, or ok=false if fail
             int x, y;
@@ -153,15 +156,16 @@ void MainWindow::objectTreeItemChanged()
     // update current properties table
     doPropertiesTableUpdate();
     drawHighlight( ptr2TestObjectKey(objectTree->currentItem()), true );
+    scheduleSignalPrefetch();
 }
 
 
 QTreeWidgetItem * MainWindow::createObjectTreeItem(QTreeWidgetItem *parentItem,
-                                                   const TreeItemInfo &data,
-                                                   QMap<QString, QStringList> duplicateItems )
+                                                   const TreeItemInfo &data )
 {
     //qDebug() << "createObjectTreeItem";
     QTreeWidgetItem *item = new QTreeWidgetItem( parentItem );
+    registerObjectItem( item );
 
     // if type or id is empty...
     QString type = data.type;
@@ -177,7 +181,9 @@ QTreeWidgetItem * MainWindow::createObjectTreeItem(QTreeWidgetItem *parentItem,
     }
 
 
-    // type column
+    // type column, colors and tooltips come from objectTreeDelegate
+
+    int flags = 0;
 
     if ( type.isEmpty() ) {
         badTypeTip = richTextContainer->testObjectMissingType->toolTip();
@@ -187,98 +193,16 @@ QTreeWidgetItem * MainWindow::createObjectTreeItem(QTreeWidgetItem *parentItem,
         }
 
         type = "<NoName>";
-        item->setBackground( 0, QColor(Qt::red) );
-        item->setForeground( 0, QColor(Qt::white) );
-
-        item->setData( 0, Qt::ToolTipRole, badTypeTip + (data.env.isEmpty()
-                                                         ? QString()
-                                                         : "\n" + tr("Test object environment: ") + data.env));
-    }
-    else {
-        item->setBackground( 0, QBrush() );
-        item->setForeground( 0, QColor(Qt::darkCyan).darker(180) );
-        if (!data.env.isEmpty()) {
-            item->setData( 0, Qt::ToolTipRole, tr("Test object environment: ") + data.env);
-        }
+        flags |= TDriverObjectTreeDelegate::MissingType;
     }
     item->setData( 0, Qt::DisplayRole, type);
 
 
-    // name column
+    // name column, duplicate names are marked after entire tree is built
 
     if ( name.isEmpty() ) {
-
         name = "<Object name not defined...>";
-
-        //item->setBackground( 1, QColor(Qt::red).lighter( 120 ) );
-        item->setBackground( 1, QColor(Qt::red) );
-        item->setForeground( 1, QColor(Qt::white) );
-
-        item->setData( 1, Qt::ToolTipRole,
-                      badTypeTip.isEmpty() ?
-                          tr(
-                              "\n  Warning!  \n"
-                              "\n"
-                              "  Name for this object is not defined in the applications source code.\n"
-                              "  Identifying objects with other attributes such as \"x\", \"y\", \"width\",\n"
-                              "  \"height\", \"text\" or \"icon\" may lead to failure of the tests.  \n"
-                              "\n"
-                              "  Object names are more likely to remain the same throughout the software life cycle.\n"
-                              "\n"
-                              "  Please contact your manager, development team or responsible person and\n"
-                              "  request for properly named objects in order to make this application more testable.\n")
-                        : badTypeTip );
-    }
-    else {
-
-        if ( duplicateItems.count( name ) != 0 ){
-
-            QStringList items = duplicateItems.value( name );
-            QString toolTipMessage;
-
-            if ( items.size() == 1 ){
-
-                toolTipMessage = tr(
-                            "\n  Warning!\n"
-                            "\n"
-                            "  Multiple objects found with same object name and id.\n"
-                            "\n"
-                            "  Identifying and accessing this test object without full stack of parent object(s)\n"
-                            "  may lead your test scripts to fail. The reason for this issue is how objects are\n"
-                            "  traversed, but usually due to there are no unique object id available.\n"
-                            "\n"
-                            "  Please contact your manager, traverser development team or responsible person\n"
-                            "  and request for unique object names and ids in order to make this application\n"
-                            "  more testable.\n" );
-
-                //name = name + " <Duplicate object name and ID>";
-            }
-            else {
-
-                if (!TDriverUtil::isSymbianSut(activeDeviceParams.value("type"))) {
-                    toolTipMessage = tr(
-                                "\n  Warning!\n"
-                                "\n"
-                                "  Multiple objects found with same object name.\n"
-                                "\n"
-                                "  Objects without unique name may lead your test scripts to fail due to multiple\n"
-                                "  test objects found exception.  Please contact your manager, development team\n"
-                                "  or responsible person and request for uniquely named objects in order to make\n"
-                                "  this application more testable.\n");
-
-                }
-                //name = name + " <Duplicate object name>";
-
-            }
-
-            item->setBackground( 1, QColor(Qt::red) );
-            item->setForeground( 1, QColor(Qt::white) );
-            item->setData( 1, Qt::ToolTipRole, badTypeTip.isEmpty() ? toolTipMessage : badTypeTip );
-        }
-        else {
-            item->setBackground( 1, QBrush() );
-            item->setForeground( 1, QColor(Qt::darkGreen) );
-        }
+        flags |= TDriverObjectTreeDelegate::MissingName;
     }
     item->setData( 1, Qt::DisplayRole, name);
 
@@ -287,15 +211,11 @@ QTreeWidgetItem * MainWindow::createObjectTreeItem(QTreeWidgetItem *parentItem,
     if ( id.isEmpty() ) {
         id = "<None>";
     }
-    item->setBackground( 2, QBrush() );
-    item->setForeground( 2, QColor(Qt::darkYellow) );
     item->setData( 2, Qt::DisplayRole, id);
 
-    // fonts for all
-
-    item->setFont( 0, *defaultFont );
-    item->setFont( 1, *defaultFont );
-    item->setFont( 2, *defaultFont );
+    if (flags) {
+        item->setData( 0, TDriverObjectTreeDelegate::FlagsRole, flags );
+    }
 
     parentItem->addChild( item );
 
@@ -303,6 +223,18 @@ QTreeWidgetItem * MainWindow::createObjectTreeItem(QTreeWidgetItem *parentItem,
 }
 
 
+TestObjectKey MainWindow::registerObjectItem(QTreeWidgetItem *item)
+{
+    // key 0 means no object
+    if (objectItems.isEmpty()) objectItems << 0;
+
+    TestObjectKey key = objectItems.size();
+    objectItems << item;
+    item->setData( 0, TestObjectKeyRole, key );
+    return key;
+}
+
+
 void MainWindow::storeItemToObjectTreeMap( QTreeWidgetItem *item, const TreeItemInfo &data)
 {
     TestObjectKey itemPtr = ptr2TestObjectKey( item );
@@ -352,10 +284,10 @@ void MainWindow::buildScreenshotObjectList(TestObjectKey parentKey)
     // check validity
     if ( parentKey && attributesMap.contains(parentKey) ) {
 
-        const QMap<QString, AttributeInfo > &attributeContainer = attributesMap[parentKey];
+        const QMap<QString, AttributeInfo > &attributeContainer = attributesMap.value(parentKey);
 
         int x, y;
-        bool ok = getItemPos(testObjectKey2Ptr(parentKey), x, y);
+        bool ok = getItemPos(objectItem(parentKey), x, y);
 
         ok = (ok && attributeContainer.contains("height") && attributeContainer.contains("width"))
                 || attributeContainer.contains("geometry");
@@ -377,7 +309,7 @@ void MainWindow::buildScreenshotObjectList(TestObjectKey parentKey)
         }
 
         // recurse into all children
-        QTreeWidgetItem *parentItem = testObjectKey2Ptr(parentKey);
+        QTreeWidgetItem *parentItem = objectItem(parentKey);
         for (int ii=0; ii < parentItem->childCount(); ++ii) {
             buildScreenshotObjectList(ptr2TestObjectKey(parentItem->child(ii)));
         }
@@ -385,121 +317,97 @@ void MainWindow::buildScreenshotObjectList(TestObjectKey parentKey)
 }
 
 
-QList<QMap<QString, QString> > MainWindow::collectObjectData( QDomElement element )
+void MainWindow::markDuplicateObjectNames()
 {
-    QList<QMap<QString, QString> > results;
-    QDomNode node = element.firstChild();
+    if (!locatorAnalyzer) return;
 
-    while ( !node.isNull() ) {
-
-        if ( node.isElement() && node.nodeName() == "objects" ){
-            results << collectObjectData( node.toElement() );
-        }
+    for (int ordinal = 0; ordinal < objectIndex->count(); ++ordinal) {
+        if (!locatorAnalyzer->hasDuplicateName(ordinal)) continue;
 
-        if ( node.isElement() && node.nodeName() == "object" ){
-            QDomElement tmpElement( node.toElement() );
+        QTreeWidgetItem *item = objectItem(objectIndex->key(ordinal));
+        int flags = item->data(0, TDriverObjectTreeDelegate::FlagsRole).toInt();
 
-            if ( tmpElement.attribute( "name" ) != "" ){
-                QMap<QString, QString> tmpValue;
-                tmpValue.insert( "name", tmpElement.attribute( "name" ) );
-                tmpValue.insert( "id", tmpElement.attribute( "id" ) );
-                results << tmpValue;
-            }
-
-            results << collectObjectData( node.toElement() );
-        }
-
-        node = node.nextSibling();
+        flags |= locatorAnalyzer->hasDuplicateNameAndId(ordinal)
+                ? TDriverObjectTreeDelegate::DuplicateNameAndId
+                : TDriverObjectTreeDelegate::DuplicateName;
+        item->setData( 0, TDriverObjectTreeDelegate::FlagsRole, flags );
     }
-
-    return results;
 }
 
-// for agent_qt 1.3 or later (with new xml format)
-QList<QMap<QString, QString> > MainWindow::collectObjectData_new_format( QDomElement element )
-{
-    QList<QMap<QString, QString> > results;
-    QDomNode node = element.firstChild();
-
-    while ( !node.isNull() ) {
-
-        if ( node.isElement() && node.nodeName() == "obj" ){
-            QDomElement tmpElement( node.toElement() );
 
-            if ( tmpElement.attribute( "name" ) != "" ){
-                QMap<QString, QString> tmpValue;
-                tmpValue.insert( "name", tmpElement.attribute( "name" ) );
-                tmpValue.insert( "id", tmpElement.attribute( "id" ) );
-                results << tmpValue;
-            }
-
-            results << collectObjectData_new_format( node.toElement() );
+// Tooltips are built when requested instead of storing the same long texts
+// for every marked item.
+QString MainWindow::objectTreeToolTip(QTreeWidgetItem *item, int column)
+{
+    int flags = item->data(0, TDriverObjectTreeDelegate::FlagsRole).toInt();
+    QString env = objectTreeData.value(ptr2TestObjectKey(item)).env;
+    QString envTip = env.isEmpty() ? QString() : tr("Test object environment: ") + env;
+
+    if (column == 0) {
+        if (flags & TDriverObjectTreeDelegate::MissingType) {
+            QString badTypeTip = richTextContainer->testObjectMissingType->toolTip();
+            return envTip.isEmpty() ? badTypeTip : badTypeTip + "\n" + envTip;
         }
-
-        node = node.nextSibling();
+        return envTip;
     }
 
-    return results;
-}
+    if (column != 1) return QString();
 
-QMap<QString, QStringList> MainWindow::findDuplicateObjectNames( QList<QMap<QString, QString> > objects )
-{
-    QMap<QString, QStringList> results;
-    QMap<QString, QStringList> foundObjects;
-
-    if ( objects.size() > 0 ) {
-
-        for ( int i = 0; i < objects.size(); i++ ) {
-
-            //qDebug() << "--";
-            QMap<QString, QString> object = objects.at( i );
-            QString objectName = object.value( "name" );
-            QString objectId = object.value( "id" );
-            bool duplicate = false;
-            QStringList objectIds;
-
-            if ( foundObjects.count( objectName ) != 0 ) {
-
-                objectIds = foundObjects[ objectName ];
-                //qDebug() << "objectIds: " << objectIds;
+    // missing type tooltip is more important
+    if (flags & TDriverObjectTreeDelegate::MissingType) {
+        return (flags & TDriverObjectTreeDelegate::MissingName)
+                ? richTextContainer->testObjectMissingType->toolTip()
+                : QString();
+    }
 
-                if ( objectIds.contains( objectId ) == true ){
-                    //qDebug() << "objects name and id are identical, show warning...";
-                    duplicate = true;
-                }
-                else {
-                    duplicate = true;
-                    objectIds << objectId;
-                    foundObjects[ objectName ] = objectIds;
-                }
+    if (flags & TDriverObjectTreeDelegate::MissingName) {
+        return tr(
+                    "\n  Warning!  \n"
+                    "\n"
+                    "  Name for this object is not defined in the applications source code.\n"
+                    "  Identifying objects with other attributes such as \"x\", \"y\", \"width\",\n"
+                    "  \"height\", \"text\" or \"icon\" may lead to failure of the tests.  \n"
+                    "\n"
+                    "  Object names are more likely to remain the same throughout the software life cycle.\n"
+                    "\n"
+                    "  Please contact your manager, development team or responsible person and\n"
+                    "  request for properly named objects in order to make this application more testable.\n");
+    }
 
-                results[ objectName ] = objectIds;
-                //qDebug() << objectIds;
-            }
-            else {
-                objectIds << objectId;
-                foundObjects.insert( objectName, objectIds );
-            }
+    if (flags & TDriverObjectTreeDelegate::DuplicateNameAndId) {
+        return tr(
+                    "\n  Warning!\n"
+                    "\n"
+                    "  Multiple objects found with same object name and id.\n"
+                    "\n"
+                    "  Identifying and accessing this test object without full stack of parent object(s)\n"
+                    "  may lead your test scripts to fail. The reason for this issue is how objects are\n"
+                    "  traversed, but usually due to there are no unique object id available.\n"
+                    "\n"
+                    "  Please contact your manager, traverser development team or responsible person\n"
+                    "  and request for unique object names and ids in order to make this application\n"
+                    "  more testable.\n" );
+    }
 
-            if ( duplicate == false ) {
-                //qDebug() << " not duplicate... " << object;
-            }
-            else {
-                //qDebug() << " duplicate... " << object;
-            }
-            //qDebug() << object;
-        }
+    if ((flags & TDriverObjectTreeDelegate::DuplicateName)
+            && !TDriverUtil::isSymbianSut(activeDeviceParams.value("type"))) {
+        return tr(
+                    "\n  Warning!\n"
+                    "\n"
+                    "  Multiple objects found with same object name.\n"
+                    "\n"
+                    "  Objects without unique name may lead your test scripts to fail due to multiple\n"
+                    "  test objects found exception.  Please contact your manager, development team\n"
+                    "  or responsible person and request for uniquely named objects in order to make\n"
+                    "  this application more testable.\n");
     }
 
-    return results;
+    return QString();
 }
 
 
-
-
 void MainWindow::buildObjectTree_new_format(QTreeWidgetItem *parentItem,
-                                 QDomElement parentElement,
-                                 QMap<QString, QStringList> duplicateItems )
+                                 QDomElement parentElement )
 {
     //qDebug() << "buildObjectTree_new_format";
     // create attribute hash for each attribute
@@ -544,13 +452,13 @@ void MainWindow::buildObjectTree_new_format(QTreeWidgetItem *parentItem,
                 currentApplication.set(data.id, data.name);
             }
 
-            childItem = createObjectTreeItem( parentItem, data, duplicateItems);
+            childItem = createObjectTreeItem( parentItem, data );
 
             storeItemToObjectTreeMap( childItem, data );
 
             // iterate the node recursively if child nodes exists
             if ( node.hasChildNodes() ) {
-                buildObjectTree_new_format( childItem, element, duplicateItems );
+                buildObjectTree_new_format( childItem, element );
             }
 
 
@@ -565,8 +473,7 @@ void MainWindow::buildObjectTree_new_format(QTreeWidgetItem *parentItem,
 
 
 void MainWindow::buildObjectTree(QTreeWidgetItem *parentItem,
-                                 QDomElement parentElement,
-                                 QMap<QString, QStringList> duplicateItems )
+                                 QDomElement parentElement )
 {
     //qDebug() << "buildObjectTree";
 
@@ -584,11 +491,11 @@ void MainWindow::buildObjectTree(QTreeWidgetItem *parentItem,
       {
 
         if ( node.nodeName() == "attributes" ) {
-            buildObjectTree( parentItem, node.toElement(), duplicateItems );
+            buildObjectTree( parentItem, node.toElement() );
         }
 
         if ( node.nodeName() == "objects" ) {
-            buildObjectTree( parentItem, node.toElement(), duplicateItems );
+            buildObjectTree( parentItem, node.toElement() );
         }
 
         if ( node.nodeName() == "attribute" ) {
@@ -620,12 +527,12 @@ void MainWindow::buildObjectTree(QTreeWidgetItem *parentItem,
                 currentApplication.set(data.id, data.name);
             }
 
-            childItem = createObjectTreeItem( parentItem, data, duplicateItems);
+            childItem = createObjectTreeItem( parentItem, data );
             storeItemToObjectTreeMap( childItem, data );
 
             // iterate the node recursively if child nodes exists
             if ( node.hasChildNodes() ) {
-                buildObjectTree( childItem, element, duplicateItems );
+                buildObjectTree( childItem, element );
             }
 
 
@@ -656,6 +563,24 @@ void MainWindow::clearObjectTreeMappings()
     // empty object tree data mappings (eg. type, name & id)
     objectTreeData.clear();
     objectIdMap.clear();
+    objectItems.clear();
+
+    // empty search index
+    objectIndex.clear();
+    locatorAnalyzer.clear();
+    findAllPanel->setIndex(objectIndex);
+    objectQueryResults.clear();
+    objectQueryLastText.clear();
+
+    // queued prefetch keys point to removed items
+    signalPrefetchQueue.clear();
+
+    // keys are reused from 1 when tree is rebuilt, so keys kept from old tree would
+    // refer to unrelated new objects
+    lastHighlightedObjectKey = 0;
+    collapsedObjectTreeItemPtr = 0;
+    expandedObjectTreeItemPtr = 0;
+    findDialogSubtreeRoot = NULL;
 }
 
 
@@ -720,18 +645,9 @@ void MainWindow::updateObjectTree( QString filename )
                 sutItem->setData( 1, Qt::DisplayRole, treeItemData.name );
                 sutItem->setData( 2, Qt::DisplayRole, sutId );
 
-                sutItem->setForeground( 0, QColor(Qt::darkCyan).darker(180) );
-                sutItem->setForeground( 1, QColor(Qt::darkGreen) );
-                sutItem->setForeground( 2, QColor(Qt::darkYellow) );
-
-                sutItem->setFont( 0, *defaultFont );
-                sutItem->setFont( 1, *defaultFont );
-                sutItem->setFont( 2, *defaultFont );
-
                 objectTree->addTopLevelItem ( sutItem );
-                objectIdMap.insert(sutId, ptr2TestObjectKey(sutItem));
-
-                TestObjectKey itemPtr = ptr2TestObjectKey( sutItem );
+                TestObjectKey itemPtr = registerObjectItem( sutItem );
+                objectIdMap.insert(sutId, itemPtr);
 
                 // store object tree data
                 objectTreeData.insert( itemPtr, treeItemData );
@@ -739,18 +655,12 @@ void MainWindow::updateObjectTree( QString filename )
                 // determine whether to use new xml structure or not... (new == 1.3+)
                 if ( !checkVersion( version, "1.3" ) ) {
 
-                  QList<QMap<QString,QString> > objectNamesList = collectObjectData( element );
-                  QMap<QString, QStringList> duplicateItems = findDuplicateObjectNames( objectNamesList );
-
                   // build object tree with xml
-                  buildObjectTree( sutItem, element, duplicateItems );
+                  buildObjectTree( sutItem, element );
 
                 } else {
 
-                  QList<QMap<QString,QString> > objectNamesList = collectObjectData_new_format( element );
-                  QMap<QString, QStringList> duplicateItems = findDuplicateObjectNames( objectNamesList );
-
-                  buildObjectTree_new_format( sutItem, element, duplicateItems );
+                  buildObjectTree_new_format( sutItem, element );
 
                 }
 
@@ -765,9 +675,8 @@ void MainWindow::updateObjectTree( QString filename )
         RectList dummy;
         collectGeometries(sutItem, dummy);
         refreshScreenshotObjectList();
-        if (lastHighlightedObjectKey && !screenshotObjects.contains(lastHighlightedObjectKey)) {
-            lastHighlightedObjectKey = 0;
-        }
+        rebuildObjectIndex();
+        markDuplicateObjectNames();
 
         bool itemFocusChanged = false;
 
@@ -777,7 +686,7 @@ void MainWindow::updateObjectTree( QString filename )
             TestObjectKey currentFocusKey = objectIdMap.value(currentFocusId);
 
             if (currentFocusKey) {
-                objectTree->setCurrentItem(testObjectKey2Ptr(currentFocusKey));
+                objectTree->setCurrentItem(objectItem(currentFocusKey));
                 itemFocusChanged = true;
             }
         }
@@ -790,6 +699,9 @@ void MainWindow::updateObjectTree( QString filename )
         // highlight current object
         drawHighlight( ptr2TestObjectKey(objectTree->currentItem()), true );
         doPropertiesTableUpdate();
+
+        // once per rebuild, not on every current item change
+        resizeObjectTree();
     }
     else {
         qWarning("%s:%i: got no tasInfo elements from XML file '%s', returning from method",
@@ -960,7 +872,10 @@ void MainWindow::refreshAppearance()
 {
     if (defaultFont) {
         if (objectTree) objectTree->setFont(*defaultFont);
-        if (propertiesTable) propertiesTable->setFont(*defaultFont);
+        if (propertiesTable) {
+            propertiesTable->setFont(*defaultFont);
+            propertiesTable->verticalHeader()->setDefaultSectionSize(QFontMetrics(*defaultFont).height() + 6);
+        }
         if (methodsTable) methodsTable->setFont(*defaultFont);
         if (signalsTable) signalsTable->setFont(*defaultFont);
     }
@@ -994,36 +909,40 @@ void MainWindow::objectViewCurrentItemChanged ( QTreeWidgetItem * itemCurrent, Q
     expandedObjectTreeItemPtr = 0;
     objectTreeItemChanged();
     imageWidget->update();
-    resizeObjectTree();
 }
 
 
+// Returns locator of object, which is unique among descendants of its parent,
+// for building locators with full path
 QString MainWindow::treeObjectRubyId(TestObjectKey treeItemPtr, TestObjectKey sutItemPtr)
 {
     const TreeItemInfo &treeItemData = objectTreeData.value( treeItemPtr );
-    QString objRubyId = treeItemData.type;
-    QString objName = treeItemData.name;
-    QString objText = attributesMap.value( treeItemPtr ).value("text").value;
 
-    if ( sutItemPtr == treeItemPtr && objRubyId == "sut" ) {
-        objRubyId = "TDriver.sut( :Id => "
+    if ( sutItemPtr == treeItemPtr && treeItemData.type == "sut" ) {
+        return "TDriver.sut( :Id => "
                 + TDriverUtil::rubySingleQuote(activeDevice)
                 + " )";
     }
-    else if ( objName != "NoName" && !objName.isEmpty() ) {
-        objRubyId.append("( :name => "
-                         + TDriverUtil::rubySingleQuote(objName)
-                         + " )");
-    }
-    else if(objText != "" && !objText.isEmpty()) {
-        objRubyId.append("( :text => "
-                         + TDriverUtil::rubySingleQuote(attributesMap.value( treeItemPtr ).value("text").value)
-                         + " )");
-    }
-    else {
-        objRubyId.append("( :name => '' )");
+
+    if (!locatorAnalyzer) rebuildObjectIndex();
+
+    int ordinal = objectIndex->ordinal(treeItemPtr);
+    return locatorAnalyzer->segment(ordinal, objectIndex->parent(ordinal));
+}
+
+
+// Returns locator of object, which is unique in entire object tree
+QString MainWindow::treeObjectLocator(TestObjectKey treeItemPtr, TestObjectKey sutItemPtr)
+{
+    if (treeItemPtr == sutItemPtr) return treeObjectRubyId(treeItemPtr, sutItemPtr);
+
+    if (!locatorAnalyzer) rebuildObjectIndex();
+
+    int ordinal = objectIndex->ordinal(treeItemPtr);
+    if (locatorAnalyzer->locatorNeedsIndex(ordinal)) {
+        statusbar(tr("Object can't be identified uniquely without :__index"), 5000);
     }
-    return objRubyId;
+    return locatorAnalyzer->locator(ordinal);
 }
 
 
@@ -1036,13 +955,17 @@ void MainWindow::objectViewItemAction( QTreeWidgetItem * item, int column, Conte
         TestObjectKey sutItemPtr = ptr2TestObjectKey(objectTree->topLevelItem(0));
         const bool fullPath = (ptr2TestObjectKey(item) == sutItemPtr) || isPathAction(action) ;
 
-        // TODO: use XPath to determine if object is unique, and eg. insert line in comments if it's not unique
         QString result;
 
-        do {
-            result = TDriverUtil::smartJoin(
-                        treeObjectRubyId(ptr2TestObjectKey(item), sutItemPtr), '.', result);
-        } while (fullPath && ptr2TestObjectKey(item) != sutItemPtr && (item = item->parent()));
+        if (fullPath) {
+            do {
+                result = TDriverUtil::smartJoin(
+                            treeObjectRubyId(ptr2TestObjectKey(item), sutItemPtr), '.', result);
+            } while (ptr2TestObjectKey(item) != sutItemPtr && (item = item->parent()));
+        }
+        else {
+            result = treeObjectLocator(ptr2TestObjectKey(item), sutItemPtr);
+        }
 
         switch (action) {
 
@@ -1105,7 +1028,13 @@ void MainWindow::objectTreeExpandAll() {
     // exit if object tree is empty
     if ( currentItem == 0 ) { return; }
 
+    // expanding emits no per item signals, so one layout pass and one
+    // column resize are enough for the whole tree
+    objectTree->setUpdatesEnabled(false);
     objectTree->expandAll();
+    objectTree->setUpdatesEnabled(true);
+
+    resizeObjectTree();
     objectTree->scrollToItem( objectTree->currentItem() );
 
 }
@@ -19,6 +19,7 @@
 
 
 #include "tdriver_main_window.h"
+#include "tdriver_attributesmodel.h"
 #include <tdriver_tabbededitor.h>
 
 #include <tdriver_debug_macros.h>
@@ -46,8 +47,7 @@ void MainWindow::clearPropertiesTableContents() {
     signalsTable->setRowCount( 0 );
 
     // clear properties table contents
-    propertiesTable->clearContents();
-    propertiesTable->setRowCount( 0 );
+    propertiesModel->clear();
 
     propertyTabLastTimeUpdated.clear();
 
@@ -103,6 +103,8 @@ void MainWindow::sendUpdateApiTableContent()
                 return;
             }
 
+            syncMetadataCache();
+
             // retrieve methods using fixture if not already found from api methods cache
             if ( !apiMethodsMap.contains( objectType ) ) {
                 qDebug() << "requesting apiMethods for " << objectType;
@@ -201,12 +203,11 @@ void MainWindow::updateMethodsTableContent() {
 
                 behaviour = behavioursMap.value( objectTypes.at( objectTypeIndex ) );
 
-                QStringList methodsList = behaviour.getMethodsList();
+                const QVector<BehaviourMethod> &methods = behaviour.getMethods();
 
-                for ( int methodIndex = 0; methodIndex < methodsList.size(); methodIndex++ ) {
+                for ( int methodIndex = 0; methodIndex < methods.size(); methodIndex++ ) {
 
-                    // retrieve method hash
-                    QMap<QString, QString> method = behaviour.getMethod( methodsList.at( methodIndex ) );
+                    const BehaviourMethod &method = methods.at( methodIndex );
 
                     // retrieve current item count
                     int rowNumber = methodsTable->rowCount();
@@ -215,16 +216,16 @@ void MainWindow::updateMethodsTableContent() {
                     methodsTable->insertRow( rowNumber );
 
                     // add method name
-                    QTableWidgetItem *methodName = new QTableWidgetItem( methodsList.at( methodIndex ) );
+                    QTableWidgetItem *methodName = new QTableWidgetItem( method.name );
                     methodName->setFlags( Qt::ItemIsSelectable | Qt::ItemIsEnabled );
-                    methodName->setToolTip( method.value( "description" ) );
+                    methodName->setToolTip( method.description );
                     methodName->setFont( *defaultFont );
                     methodsTable->setItem( rowNumber, 0, methodName );
 
                     // add method example
-                    QTableWidgetItem *methodExample = new QTableWidgetItem( method.value( "example" ) );
+                    QTableWidgetItem *methodExample = new QTableWidgetItem( method.example );
                     methodExample->setFlags( Qt::ItemIsSelectable | Qt::ItemIsEnabled );
-                    methodExample->setToolTip( method.value( "description" ) );
+                    methodExample->setToolTip( method.description );
                     methodExample->setFont( *defaultFont );
                     methodsTable->setItem( rowNumber, 1, methodExample );
 
@@ -266,6 +267,17 @@ bool MainWindow::sendUpdateSignalsTableContent()
         QString objectId   = objectTreeData.value(currentItemPtr).id;
         QString env = objectTreeData.value(currentItemPtr).env;
 
+        syncMetadataCache();
+        if ( apiSignalsMap.contains( objectType ) ) {
+            fillSignalsTable( apiSignalsMap.value( objectType ) );
+            return false;
+        }
+        if ( signalPrefetchInFlight.contains( objectType ) ) {
+            // signalPrefetchReceived fills the table
+            statusbar(tr("Getting signals..."), 3000);
+            return false;
+        }
+
         // Retrieve the signals from the device
         if (objectType != "sut" && objectType != "QAction") {
 
@@ -285,66 +297,41 @@ bool MainWindow::sendUpdateSignalsTableContent()
 }
 
 
-void MainWindow::updateAttributesTableContent()
+void MainWindow::fillSignalsTable( const QStringList &signalsList )
 {
-    // disconnect itemChanged signal listening, reconnect after table is updated
-    disconnect(propertiesTable, SIGNAL(itemChanged(QTableWidgetItem*)),
-               this, SLOT(changePropertiesTableValue(QTableWidgetItem*)) );
+    foreach(const QString &signalName, signalsList) {
+        // add signal name
+        QTableWidgetItem *signalItem = new QTableWidgetItem( signalName );
+        signalItem->setFlags( Qt::ItemIsSelectable | Qt::ItemIsEnabled );
+        signalItem->setFont( *defaultFont );
+
+        // append new line to table
+        int rowNumber = signalsTable->rowCount();
+        signalsTable->insertRow( rowNumber );
+        signalsTable->setItem( rowNumber, 0, signalItem );
+    }
+    // sort signals table
+    signalsTable->sortItems( 0 );
+    signalsTable->resizeColumnToContents (0);
+}
+
 
+void MainWindow::updateAttributesTableContent()
+{
     // retrieve pointer of currently selected objectTree item
     TestObjectKey currentItemPtr = ptr2TestObjectKey( objectTree->currentItem() );
 
-    // clear properties table contents
-    propertiesTable->clearContents();
-    propertiesTable->setRowCount( 0 );
-
-    if ( attributesMap.contains( currentItemPtr ) && objectTree->currentItem() != NULL ) {
-
-        // set number of attributes in table
-        propertiesTable->setRowCount( attributesMap.value( currentItemPtr ).size() );
-
-        // retrieve current objects attributes (using pointer of QTreeWidgetItem)
-        QMapIterator<QString, AttributeInfo > iterator( attributesMap.value( currentItemPtr ) );
-
-        int index = 0;
-        while ( iterator.hasNext() ) {
-
-            iterator.next();
-
-            QString attributeName      = iterator.value().name;
-            QString attributeValue     = iterator.value().value;
-            QString attributeType      = iterator.value().type;
-
-            // Attribute name
-            QTableWidgetItem *attributeNameItem = new QTableWidgetItem( attributeName );
-            attributeNameItem->setFont( *defaultFont );
-            attributeNameItem->setFlags( Qt::ItemIsSelectable | Qt::ItemIsEnabled );
-            propertiesTable->setItem( index, 0, attributeNameItem );
-
-            // Attribute value
-            QTableWidgetItem *attributeValueItem = new QTableWidgetItem( attributeValue );
-            attributeValueItem->setFont( *defaultFont );
-
-            // Attribute type - non writable attributes must not be accessible - "w" or "writable"
-            if ( !attributeType.contains( "w", Qt::CaseInsensitive ) ) {
-
-                // make item selectabe & enabled for copying, but not editable
-                //Qt::ItemFlags newFlags = Qt::ItemIsSelectable | Qt::ItemIsEnabled;
-                attributeValueItem->setFlags( Qt::ItemIsSelectable | Qt::ItemIsEnabled );
-
-                // paint item gray
-                attributeValueItem->setBackground( QBrush( Qt::lightGray ) );
-
-            }
-
-            propertiesTable->setItem( index, 1, attributeValueItem );
-            index++;
-        }
+    // view queries model only for visible rows, no per-cell items are created
+    if ( objectTree->currentItem() != NULL ) {
+        propertiesModel->setAttributes( attributesMap.value( currentItemPtr ) );
+    }
+    else {
+        propertiesModel->clear();
+    }
 
-        connect(propertiesTable, SIGNAL(itemChanged(QTableWidgetItem*)),
-                SLOT(changePropertiesTableValue(QTableWidgetItem*)) );
-        propertiesTable->update();
-        propertiesTable->resizeColumnsToContents();
+    // name column width is sampled from limited number of rows, see header resizeContentsPrecision
+    if ( propertiesModel->rowCount() > 0 ) {
+        propertiesTable->resizeColumnToContents( TDriverAttributesModel::NameColumn );
     }
     propertyTabLastTimeUpdated.insert( "attributes", currentItemPtr );
 }
@@ -358,8 +345,11 @@ void MainWindow::connectTabWidgetSignals()
     connect(methodsTable, SIGNAL(itemPressed(QTableWidgetItem*)),
             SLOT(methodItemPressed(QTableWidgetItem*)) );
 
-    connect(propertiesTable, SIGNAL(itemPressed(QTableWidgetItem*)),
-            SLOT(propertiesItemPressed(QTableWidgetItem*)) );
+    connect(propertiesTable, SIGNAL(pressed(QModelIndex)),
+            SLOT(propertiesItemPressed(QModelIndex)) );
+
+    connect(propertiesModel, SIGNAL(attributeEdited(QString,QString)),
+            SLOT(changePropertiesTableValue(QString,QString)) );
 
 #if !DISABLE_API_TAB_PENDING_REMOVAL
     connect(apiTable, SIGNAL(itemPressed(QTableWidgetItem*)),
@@ -368,7 +358,7 @@ void MainWindow::connectTabWidgetSignals()
 }
 
 
-void MainWindow::changePropertiesTableValue( QTableWidgetItem *item )
+void MainWindow::changePropertiesTableValue( const QString &attributeName, const QString &value )
 {
     TestObjectKey currentItemPtr = ptr2TestObjectKey( objectTree->currentItem() );
     const TreeItemInfo &treeItemData = objectTreeData.value( currentItemPtr );
@@ -376,8 +366,6 @@ void MainWindow::changePropertiesTableValue( QTableWidgetItem *item )
     // this feature is not supported in with env != qt
     if (treeItemData.env.toLower() == "qt") {
 
-        QTableWidgetItem *currentItem = propertiesTable->item( propertiesTable->row( item ), 0 );
-        QString attributeName = currentItem->text();
         QString objRubyId = treeItemData.type;
 
         objRubyId.append('(');
@@ -387,17 +375,18 @@ void MainWindow::changePropertiesTableValue( QTableWidgetItem *item )
         objRubyId.append(":id=>"+TDriverUtil::rubySingleQuote(treeItemData.id));
         objRubyId.append(')');
 
-        QString targetDataType = attributesMap.value(currentItemPtr).value(attributeName).dataType;
+        QString targetDataType = attributesMap.value(currentItemPtr).value(attributeName.toLower()).dataType;
 
         if (targetDataType.size() == 0) {
             QMessageBox::warning(this,
                                  tr("Incompatible Attribute"),
                                  tr("No data type found for attribute ") + attributeName );
 
-        } else {
+        } else if (!queueBatchOperation(QStringList() << "set_attribute" << objRubyId << targetDataType << attributeName << value,
+                                        tr("set %1 of %2").arg(attributeName, objRubyId))) {
             QStringList cmd(QStringList()
                             << activeDevice << "set_attribute"
-                            << objRubyId << targetDataType << attributeName << item->text());
+                            << objRubyId << targetDataType << attributeName << value);
 
             if (sendTDriverCommand(commandSetAttribute, cmd, tr("set attribute")) ) {
                 propertiesDock->setDisabled(true);
@@ -462,8 +451,10 @@ void MainWindow::methodItemPressed( QTableWidgetItem * item ) {
 
 
 // Handle (right) clicks on properties table: display context menu
-void MainWindow::propertiesItemPressed ( QTableWidgetItem * item )
+void MainWindow::propertiesItemPressed ( const QModelIndex &index )
 {
+    Q_UNUSED( index );
+
     if (QApplication::mouseButtons() == Qt::RightButton) {
 
         ContextMenuSelection action = showCopyAppendContextMenu();
@@ -476,19 +467,26 @@ void MainWindow::propertiesItemPressed ( QTableWidgetItem * item )
             QTreeWidgetItem * treeItem = objectTree->currentItem();
             QString objectType = treeItem->data( 0, Qt::DisplayRole ).toString();
 
-            QList<QTableWidgetItem *> selectedItems = item->tableWidget()->selectedItems();
+            // collect selected rows once each, in the order they were selected
+            QList<int> selectedRows;
+            foreach (const QModelIndex &selected, propertiesTable->selectionModel()->selectedIndexes()) {
+                if ( !selectedRows.contains( selected.row() ) ) {
+                    selectedRows << selected.row();
+                }
+            }
 
             // combine object type and selected attribute rows into a TDriver ruby test object selection script
             QString objRubyId = objectType + "(";
-            for ( int i = 0; i < selectedItems.size(); i++ ) {
+            for ( int i = 0; i < selectedRows.size(); i++ ) {
                 if (i > 0) {
                     objRubyId += ", ";
                 }
 
+                const AttributeInfo &info = propertiesModel->attribute( selectedRows[ i ] );
                 objRubyId += ":"
-                        + propertiesTable->item( selectedItems[ i ]->row(), 0 )->text()
+                        + info.name
                         + " => "
-                        + TDriverUtil::rubySingleQuote(propertiesTable->item( selectedItems[ i ]->row(), 1 )->text());
+                        + TDriverUtil::rubySingleQuote(info.value);
                 qDebug() << FCFL << objRubyId;
             }
 
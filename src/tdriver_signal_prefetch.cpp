@@ -0,0 +1,149 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#include "tdriver_main_window.h"
+
+#include "tdriver_debug_macros.h"
+
+
+// Queues signal list requests for object types near current selection and on visible
+// tree rows, so that signals tab can usually be filled from apiSignalsMap.
+void MainWindow::scheduleSignalPrefetch()
+{
+    signalPrefetchQueue.clear();
+    if (offlineMode || activeDevice.isEmpty() || objectTree->topLevelItemCount() == 0) return;
+
+    QSet<QString> queuedTypes;
+    QList<QTreeWidgetItem *> nearItems;
+
+    // current selection, its parent, siblings and children first
+    QTreeWidgetItem *current = objectTree->currentItem();
+    if (current) {
+        nearItems << current;
+        QTreeWidgetItem *parent = current->parent();
+        if (parent) {
+            nearItems << parent;
+            for (int ii = 0; ii < parent->childCount(); ++ii) nearItems << parent->child(ii);
+        }
+        for (int ii = 0; ii < current->childCount(); ++ii) nearItems << current->child(ii);
+    }
+
+    // then visible rows from top of viewport down
+    const int viewportHeight = objectTree->viewport()->height();
+    for (QTreeWidgetItem *item = objectTree->itemAt(0, 0);
+         item && objectTree->visualItemRect(item).top() < viewportHeight;
+         item = objectTree->itemBelow(item)) {
+        nearItems << item;
+    }
+
+    foreach (QTreeWidgetItem *item, nearItems) {
+        TestObjectKey key = ptr2TestObjectKey(item);
+        if (!isSignalPrefetchCandidate(key)) continue;
+
+        QString type(objectTreeData.value(key).type);
+        if (queuedTypes.contains(type)) continue;
+
+        queuedTypes.insert(type);
+        signalPrefetchQueue << key;
+    }
+
+    if (!signalPrefetchQueue.isEmpty()) {
+        qDebug() << FCFL << "queued" << signalPrefetchQueue.size() << "signal list prefetches";
+        signalPrefetchTimer->start();
+    }
+}
+
+
+bool MainWindow::isSignalPrefetchCandidate(TestObjectKey key) const
+{
+    if (!objectTreeData.contains(key)) return false;
+
+    const TreeItemInfo &info = objectTreeData.value(key);
+
+    // same conditions as in sendUpdateSignalsTableContent
+    if (info.type.isEmpty() || info.type == "sut" || info.type == "QAction" || !info.env.contains("qt")) {
+        return false;
+    }
+
+    return !apiSignalsMap.contains(info.type)
+            && !signalPrefetchInFlight.contains(info.type)
+            && !signalPrefetchFailed.contains(info.type);
+}
+
+
+// Prefetching must never delay commands caused by user, so it waits for them to finish.
+bool MainWindow::hasPendingForegroundCommands() const
+{
+    foreach (const SentTDriverMsg &msg, sentTDriverMsgs) {
+        if (msg.type != commandPrefetchSignalList) return true;
+    }
+    return doRefreshAfterAppList;
+}
+
+
+void MainWindow::sendSignalPrefetch()
+{
+    if (hasPendingForegroundCommands()) {
+        signalPrefetchTimer->start();
+        return;
+    }
+
+    while (signalPrefetchInFlight.size() < SIGNAL_PREFETCH_IN_FLIGHT_LIMIT && !signalPrefetchQueue.isEmpty()) {
+        TestObjectKey key = signalPrefetchQueue.takeFirst();
+
+        // selection may have fetched the type meanwhile
+        if (!isSignalPrefetchCandidate(key)) continue;
+
+        const TreeItemInfo &info = objectTreeData.value(key);
+        QStringList cmd(QStringList()
+                        << activeDevice << "list_signals" << currentApplication.name << info.id << info.type);
+
+        signalPrefetchInFlight.insert(info.type);
+        // null error name keeps failures out of status bar
+        sendTDriverCommand(commandPrefetchSignalList, cmd, QString(), info.type);
+    }
+}
+
+
+void MainWindow::signalPrefetchReceived(const QString &objectType, const QString &fileName)
+{
+    signalPrefetchInFlight.remove(objectType);
+
+    if (fileName.isEmpty()) {
+        qDebug() << FCFL << "signal list prefetch failed for" << objectType;
+        signalPrefetchFailed.insert(objectType);
+    }
+    else {
+        apiSignalsMap[objectType] = parseSignalsXml(fileName);
+        metadataCacheDirty = true;
+
+        // fill signals tab if it is waiting for this prefetch
+        TestObjectKey currentKey = ptr2TestObjectKey(objectTree->currentItem());
+        if (currentKey
+                && propertyTabLastTimeUpdated.value("signals") == currentKey
+                && objectTreeData.value(currentKey).type == objectType
+                && signalsTable->rowCount() == 0) {
+            fillSignalsTable(apiSignalsMap.value(objectType));
+        }
+    }
+
+    if (!signalPrefetchQueue.isEmpty()) signalPrefetchTimer->start();
+}
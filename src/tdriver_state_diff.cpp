@@ -0,0 +1,171 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#include "tdriver_main_window.h"
+#include "tdriver_image_view.h"
+#include "tdriver_imagediff.h"
+#include "tdriver_debug_macros.h"
+
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QXmlStreamReader>
+
+static const QString imageSuffix(".png");
+
+
+static inline uint attributeSignature(const QString &name, const QString &value)
+{
+    return (qHash(name.toLower()) * 33) ^ qHash(value.trimmed());
+}
+
+
+// Reads test object id -> attribute signature pairs from an ui dump file, without building a DOM.
+// Both "objects/object/attributes/attribute" and "obj/attr" formats are understood.
+static QHash<QString, uint> readObjectSignatures(const QString &fileName)
+{
+    QHash<QString, uint> result;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return result;
+
+    QXmlStreamReader xml(&file);
+    QStringList idStack;
+
+    while (!xml.atEnd()) {
+        switch (xml.readNext()) {
+
+        case QXmlStreamReader::StartElement:
+            if (xml.name() == QLatin1String("obj") || xml.name() == QLatin1String("object")) {
+                QString id = xml.attributes().value(QLatin1String("id")).toString();
+                idStack << id;
+                // inserting here makes objects without attributes visible too
+                if (!result.contains(id)) result.insert(id, 0);
+            }
+            else if (xml.name() == QLatin1String("attr") || xml.name() == QLatin1String("attribute")) {
+                QString name = xml.attributes().value(QLatin1String("name")).toString();
+                QString value = xml.readElementText(QXmlStreamReader::IncludeChildElements);
+                if (!idStack.isEmpty()) result[idStack.last()] += attributeSignature(name, value);
+            }
+            break;
+
+        case QXmlStreamReader::EndElement:
+            if (xml.name() == QLatin1String("obj") || xml.name() == QLatin1String("object")) {
+                if (!idStack.isEmpty()) idStack.removeLast();
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (xml.hasError()) {
+        qDebug() << FCFL << "error reading" << fileName << ":" << xml.errorString();
+    }
+
+    return result;
+}
+
+
+void MainWindow::compareImageWithHistoryDir(const QString &dirPath)
+{
+    QDir dir(dirPath);
+    QStringList xmlFiles = dir.entryList(QStringList() << "*.xml", QDir::Files);
+
+    if (xmlFiles.size() != 1) {
+        statusbar(tr("Can't compare, directory %1 does not contain exactly one .xml file").arg(dirPath), 5000);
+        return;
+    }
+
+    if (imageWidget->currentImage().isNull()) {
+        statusbar(tr("Can't compare, no current image"), 5000);
+        return;
+    }
+
+    QString xmlPath = dirPath + "/" + xmlFiles.first();
+    QString imagePath = xmlPath;
+    imagePath.replace(imagePath.lastIndexOf('.'), imagePath.size(), imageSuffix);
+
+    QImage oldImage(imagePath);
+    if (oldImage.isNull()) {
+        statusbar(tr("Can't compare, failed to load image %1").arg(imagePath), 5000);
+        return;
+    }
+
+    RectList regions = TDriverImageDiff::changedRegions(oldImage, imageWidget->currentImage());
+
+    // objects on the screenshot, whose attributes changed, and which overlap changed pixels
+    RectList changedObjects;
+    int changedAttributeCount = 0;
+
+    if (!regions.isEmpty()) {
+        QHash<QString, uint> oldSignatures = readObjectSignatures(xmlPath);
+
+        if (screenshotObjects.isEmpty()) buildScreenshotObjectList();
+
+        foreach (TestObjectKey key, screenshotObjects) {
+            const QString &id = objectTreeData.value(key).id;
+
+            uint signature = 0;
+            const QMap<QString, AttributeInfo > &attributes = attributesMap.value(key);
+            QMap<QString, AttributeInfo>::const_iterator it;
+            for (it = attributes.constBegin(); it != attributes.constEnd(); ++it) {
+                signature += attributeSignature(it.key(), it.value().value);
+            }
+
+            QHash<QString, uint>::const_iterator oldIt = oldSignatures.constFind(id);
+            if (oldIt != oldSignatures.constEnd() && oldIt.value() == signature) continue;
+            ++changedAttributeCount;
+
+            // geometries were collected for the whole tree when it was built, own rect of
+            // object is first and null if object has no geometry of its own
+            if (!geometriesMap.contains(key)) continue;
+            const RectList &geometries = geometriesMap.value(key);
+            if (geometries.isEmpty() || geometries.first().isEmpty()) continue;
+
+            const QRect &objectRect = geometries.first();
+            foreach (const QRect &region, regions) {
+                if (region.intersects(objectRect)) {
+                    changedObjects << objectRect;
+                    break;
+                }
+            }
+        }
+    }
+
+    imageWidget->drawDiff(regions, changedObjects);
+
+    if (regions.isEmpty()) {
+        statusbar(tr("No changes in image compared to %1").arg(dir.dirName()), 5000);
+    }
+    else {
+        statusbar(tr("%1 changed image areas, %2 changed objects (%3 with changed attributes) compared to %4")
+                  .arg(regions.size()).arg(changedObjects.size()).arg(changedAttributeCount).arg(dir.dirName()),
+                  10000);
+    }
+}
+
+
+void MainWindow::clearImageDiff()
+{
+    imageWidget->clearDiff();
+}
+
@@ -21,6 +21,9 @@
 
 #include "tdriver_main_window.h"
 #include "tdriver_image_view.h"
+#include "tdriver_statehistorymenu.h"
+#include "tdriver_attributesmodel.h"
+#include "tdriver_objecttreedelegate.h"
 
 #include "../common/version.h"
 
@@ -30,6 +33,7 @@
 #include <QUrl>
 #include <QScrollArea>
 #include <QToolBar>
+#include <QToolButton>
 
 #include "tdriver_debug_macros.h"
 
@@ -120,6 +124,7 @@ void MainWindow::createUi()
     createImageViewDockWidget();
     createTreeViewDockWidget();
     createPropertiesDockWidget();
+    createFindAllDockWidget();
     createTopMenuBar();
     createAppsBar();
     createShortcutsBar();
@@ -134,9 +139,18 @@ void MainWindow::createUi()
     createKeyboardCommands();
 #endif
 
-    // layout of main window: add objecttree to central and set it, add menubar as menu
+    // layout of main window: add objecttree with query line to central and set it, add menubar as menu
     statusBar()->setObjectName("main");
-    setCentralWidget( objectTree );
+    {
+        QWidget *treeContainer = new QWidget();
+        treeContainer->setObjectName("tree container");
+        QVBoxLayout *treeLayout = new QVBoxLayout(treeContainer);
+        treeLayout->setContentsMargins(0, 0, 0, 0);
+        treeLayout->setSpacing(2);
+        treeLayout->addWidget(objectQueryEdit);
+        treeLayout->addWidget(objectTree);
+        setCentralWidget( treeContainer );
+    }
     setMenuBar( menubar );
 
     updateWindowTitle();
@@ -203,6 +217,13 @@ void MainWindow::createTreeViewDockWidget()
 
     objectTree->header()->setStretchLastSection( true );
     objectTree->header()->setSectionResizeMode( QHeaderView::Interactive );
+    // resizing columns to contents samples rows instead of measuring every item
+    objectTree->header()->setResizeContentsPrecision( 200 );
+
+    // all rows use the tree font, so row heights need not be queried per item
+    objectTree->setUniformRowHeights( true );
+    objectTree->setItemDelegate( new TDriverObjectTreeDelegate(objectTree) );
+    objectTree->viewport()->installEventFilter( this );
 
     objectTree->setColumnCount( 3 );
 
@@ -217,6 +238,12 @@ void MainWindow::createTreeViewDockWidget()
     labels << " type " << " name " << " id ";
     objectTree->setHeaderLabels ( labels );
 
+    objectQueryEdit = new QLineEdit();
+    objectQueryEdit->setObjectName("tree query");
+    objectQueryEdit->setPlaceholderText(tr("Query, for example //QPushButton[@visible='true' and @text~='OK']"));
+    objectQueryEdit->setToolTip(tr("Press Enter to select next object matching the query"));
+    connect(objectQueryEdit, SIGNAL(returnPressed()), this, SLOT(runObjectQuery()));
+
 }
 
 // create properties dock widget
@@ -258,14 +285,21 @@ void MainWindow::createPropertiesDockWidgetPropertiesTabWidget() {
     propertiesLayout->setObjectName("properties attributes");
     propertiesTab->setLayout(propertiesLayout);
 
-    propertiesTable = new QTableWidget(propertiesTab);
+    propertiesModel = new TDriverAttributesModel(this);
+    propertiesModel->setObjectName("properties attributes model");
+
+    propertiesTable = new QTableView(propertiesTab);
     propertiesTable->setObjectName("properties attributes");
+    propertiesTable->setModel(propertiesModel);
+    propertiesTable->setWordWrap(false);
+
+    // fixed row heights and a limited column width sample, so view never measures all rows
+    propertiesTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    propertiesTable->verticalHeader()->setDefaultSectionSize(propertiesTable->fontMetrics().height() + 6);
+    propertiesTable->horizontalHeader()->setResizeContentsPrecision(100);
+    propertiesTable->horizontalHeader()->setStretchLastSection(true);
 
     propertiesLayout->addWidget(propertiesTable);
-    propertiesTable->clear();
-    propertiesTable->setColumnCount(2);
-    //    propertiesTable->setFont( *defaultFont );
-    setupTableWidgetHeader( "Name|Value", propertiesTable );
 
     tabWidget->addTab(propertiesTab, QString());
 
@@ -399,6 +433,21 @@ void MainWindow::createImageViewDockWidget()
         imageLeftClickChooser->addItem(tr("Left click inserts object tap"), TDriverImageView::ED_TESTOBJ_INSERT);
         container->addWidget(imageLeftClickChooser);
 
+        QToolButton *compareButton = new QToolButton();
+        compareButton->setObjectName("imageview compare");
+        compareButton->setText(tr("Compare"));
+        compareButton->setToolTip(tr("Highlight changes compared to a previous state"));
+        compareButton->setPopupMode(QToolButton::InstantPopup);
+
+        QMenu *compareMenu = new QMenu(compareButton);
+        TDriverStateHistoryMenu *compareHistoryMenu = new TDriverStateHistoryMenu(stateHistoryFilePathPrefix, compareMenu);
+        compareHistoryMenu->setTitle(tr("With state history"));
+        compareMenu->addMenu(compareHistoryMenu);
+        connect(compareHistoryMenu, SIGNAL(activated(QString)), this, SLOT(compareImageWithHistoryDir(QString)));
+        compareMenu->addAction(tr("Clear comparison"), this, SLOT(clearImageDiff()));
+        compareButton->setMenu(compareMenu);
+        container->addWidget(compareButton);
+
         layout->addWidget(container);
     }
 
@@ -0,0 +1,100 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#include "tdriver_main_window.h"
+
+#include "tdriver_debug_macros.h"
+
+
+void MainWindow::toggleWatchMode(bool enabled)
+{
+    if (enabled && !isDeviceSelected()) {
+        noDeviceSelectedPopup();
+        watchModeAction->setChecked(false);
+        return;
+    }
+
+    watchInterval = WATCH_INTERVAL_MIN;
+    if (enabled) {
+        statusbar(tr("Watch mode started"), 2000);
+        watchTimer->start(0);
+    }
+    else {
+        watchTimer->stop();
+        statusbar(tr("Watch mode stopped"), 2000);
+    }
+}
+
+
+// Asks digest of current UI dump. The dump itself is returned only if digest differs
+// from the previous one, so an unchanged SUT costs no file transfer or parsing here.
+void MainWindow::sendWatchPoll()
+{
+    if (!watchModeAction->isChecked()) return;
+
+    // never compete with refreshes or other commands, just check again later
+    if (hasPendingForegroundCommands()) {
+        watchTimer->start(watchInterval);
+        return;
+    }
+
+    QStringList cmd = constructRefreshCmd("watch_ui");
+    if (cmd.isEmpty()) {
+        watchModeAction->setChecked(false);
+        return;
+    }
+    cmd.insert(2, watchDigest.isEmpty() ? QString("-") : watchDigest);
+
+    // null error name keeps frequent polls out of status bar
+    if (!sendTDriverCommand(commandWatchUi, cmd, QString())) {
+        watchModeAction->setChecked(false);
+    }
+}
+
+
+void MainWindow::handleWatchReply(const BAListMap &reply)
+{
+    watchDigest = QString::fromLatin1(reply.value("ui_digest").value(0));
+    QString fileName(reply.value("ui_filename").value(0));
+
+    if (fileName.isEmpty()) {
+        // unchanged, back off
+        watchInterval = qMin(watchInterval * 2, int(WATCH_INTERVAL_MAX));
+    }
+    else {
+        watchInterval = WATCH_INTERVAL_MIN;
+        statusbar(tr("Watch: UI changed, updating..."), 1000);
+
+        updateObjectTree(fileName);
+        titleFileText.clear();
+        updateWindowTitle();
+
+        if (!sendUpdateBehaviourXml()) {
+            propertiesDock->setDisabled(false);
+        }
+        scheduleSignalPrefetch();
+        sendImageRequest();
+    }
+
+    if (watchModeAction->isChecked()) {
+        watchTimer->start(watchInterval);
+    }
+}
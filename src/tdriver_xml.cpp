@@ -32,6 +32,8 @@ bool MainWindow::sendUpdateBehaviourXml()
 {
     if (objectTree->invisibleRootItem()->childCount() <= 0) return false;
 
+    syncMetadataCache();
+
     QStringList objectTypes;
     QTreeWidgetItem *root = objectTree->invisibleRootItem();
     QTreeWidgetItem *node = root;
@@ -46,6 +48,15 @@ bool MainWindow::sendUpdateBehaviourXml()
         }
     }
 
+    if ( objectTypes.isEmpty() ) {
+        // everything was already cached, no need to ask behaviours from device
+        qDebug() << FCFL << "all behaviours cached";
+        propertyTabLastTimeUpdated.insert( "methods", 0 );
+        doPropertiesTableUpdate();
+        propertiesDock->setDisabled(false);
+        return true;
+    }
+
     QString objectType;
 
     // build a string of object types
@@ -67,97 +78,103 @@ bool MainWindow::sendUpdateBehaviourXml()
 }
 
 
-void MainWindow::buildBehavioursMap() {
-
-    // qDebug() << "buildBehavioursMap()";
-
-    // behavioursMap.clear();
-
-    QDomNodeList nodeList = behaviorDomDocument.documentElement().elementsByTagName( "behaviour" );
-
-    for ( int behaviourIndex = 0; behaviourIndex < nodeList.size(); behaviourIndex++ ) {
-
-        QDomNode node = nodeList.item( behaviourIndex );
+// returns text equal to given text from pool, so that identical strings share data
+static inline QString sharedString( QHash<QString, QString> &pool, const QString &text )
+{
+    QHash<QString, QString>::const_iterator it = pool.constFind( text );
+    if ( it == pool.constEnd() ) {
+        it = pool.insert( text, text );
+    }
+    return it.value();
+}
 
-        if ( node.isElement() ) {
 
-            /*
-<?xml version="1.0"?>
-<behaviours>
-<behaviour object_type="sut">
-<object_method name="kill_started_processes">
-        <description>Kills all of the application processed started through the server.</description>
-        <example>kill_started_processes</example>
-      </object_method><object_method name="list_apps">
-        <description>Lists all applications known to server running on SUT.</description>
-        <example>list_apps</example>
+// Parses behaviours xml in a single streaming pass, merging methods into behavioursMap:
+//
+// <behaviours>
+//   <behaviour object_type="sut">
+//     <object_method name="list_apps">
+//       <description>Lists all applications known to server running on SUT.</description>
+//       <example>list_apps</example>
+//     </object_method>
+//   </behaviour>
+// </behaviours>
+bool MainWindow::buildBehavioursMap( const QString &fileName )
+{
+    QFile xmlFile( fileName );
 
+    if ( !xmlFile.open( QIODevice::ReadOnly ) ) {
+        qDebug() << FCFL << fileName << "open error";
+        QMessageBox::critical( this, tr( "XML Error" ), tr( "Cannot open XML file %1" ).arg( fileName ) );
+        return false;
+    }
 
-*/
-            // retrieve element from node
-            QDomElement domElement = node.toElement();
+    // descriptions and examples repeat for every object type with same base behaviour
+    QHash<QString, QString> stringPool;
 
-            // retrieve target object name
-            QString targetObject       = domElement.attribute( "object_type" );
+    QXmlStreamReader xml( &xmlFile );
+    QString targetObject;
+    Behaviour behaviour;
+    BehaviourMethod method;
+    bool inBehaviour = false;
+    bool inMethod = false;
 
-            // retrieve object methods
-            QDomNodeList methodsNodeList = domElement.elementsByTagName( "object_method" );
+    while ( !xml.atEnd() ) {
 
-            //qDebug() << "target object: " << targetObject;
+        xml.readNext();
 
-            Behaviour behaviour;
+        if ( xml.isStartElement() ) {
 
-            // retrieve method from behaviours list if one already exists
-            if ( behavioursMap.contains( targetObject ) ) {
+            if ( xml.name() == "behaviour" ) {
+                targetObject = xml.attributes().value( "object_type" ).toString();
+                // retrieve method from behaviours list if one already exists
                 behaviour = behavioursMap.value( targetObject );
+                inBehaviour = true;
             }
-
-            for ( int methodIndex = 0; methodIndex < methodsNodeList.size(); methodIndex++ ) {
-
-                QDomElement methodElement = methodsNodeList.item( methodIndex ).toElement();
-                QString methodName = methodElement.attribute( "name" );
-/*
-                QString methodDescription("");
-                QXmlStreamReader xmlReader(methodElement.elementsByTagName( "description" ).item( 0 ).toElement().text());
-                while (!xmlReader.atEnd()) {
-                    if ( xmlReader.readNext() == QXmlStreamReader::Characters ) {
-                        methodDescription += xmlReader.text();
-                    }
-                }
-                QString methodExample("");
-                xmlReader.clear();
-                xmlReader.addData(methodElement.elementsByTagName( "example" ).item( 0 ).toElement().text());
-                while (!xmlReader.atEnd()) {
-                    if ( xmlReader.readNext() == QXmlStreamReader::Characters ) {
-                        methodExample += xmlReader.text();
-                    }
-                }
-                //qDebug() << methodName << methodDescription << methodExample;
-                QMap<QString, QString> methodDetails;
-                methodDetails.insert( "description", methodDescription );
-                methodDetails.insert( "example", methodExample );
-*/
-                //QString methodDescription = methodElement.elementsByTagName( "description" ).item( 0 ).toElement().text();
-                //QString methodExample = methodElement.elementsByTagName( "example" ).item( 0 ).toElement().text();
-                //qDebug() << methodName << methodDescription << methodExample;
-
-                QMap<QString, QString> methodDetails;
-
-                methodDetails.insert("description", methodElement.elementsByTagName( "description" ).item( 0 ).toElement().text() );
-                methodDetails.insert("example", methodElement.elementsByTagName( "example" ).item( 0 ).toElement().text() );
-                behaviour.addMethod( methodName, methodDetails );
-
+            else if ( inBehaviour && xml.name() == "object_method" ) {
+                method = BehaviourMethod();
+                method.name = xml.attributes().value( "name" ).toString();
+                inMethod = true;
+            }
+            else if ( inMethod && xml.name() == "description" ) {
+                method.description = sharedString( stringPool, xml.readElementText( QXmlStreamReader::IncludeChildElements ) );
+            }
+            else if ( inMethod && xml.name() == "example" ) {
+                method.example = sharedString( stringPool, xml.readElementText( QXmlStreamReader::IncludeChildElements ) );
             }
-
-            behavioursMap.insert( targetObject, behaviour );
-
         }
+        else if ( xml.isEndElement() ) {
 
+            if ( inMethod && xml.name() == "object_method" ) {
+                behaviour.addMethod( method );
+                inMethod = false;
+            }
+            else if ( inBehaviour && xml.name() == "behaviour" ) {
+                behavioursMap.insert( targetObject, behaviour );
+                behaviour = Behaviour();
+                inBehaviour = false;
+            }
+        }
+    }
 
+    if ( xml.hasError() ) {
+        qDebug() << FCFL << fileName << 'l' << xml.lineNumber() << 'c' << xml.columnNumber() << ':' << xml.errorString();
+        QMessageBox::critical(
+                this,
+                tr( "XML Error" ),
+                tr( "XML parse error in file %1 line %2 column %3:\n\n%4" )
+                    .arg(fileName)
+                    .arg(xml.lineNumber())
+                    .arg(xml.columnNumber())
+                    .arg(xml.errorString())
+                );
+        return false;
     }
 
+    return true;
 }
 
+
 void MainWindow::updateApplicationsList()
 {
     QMap<QString, QString>::const_iterator iterator;
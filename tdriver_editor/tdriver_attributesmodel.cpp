@@ -0,0 +1,162 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#include "tdriver_attributesmodel.h"
+
+#include <QBrush>
+#include <QColor>
+
+TDriverAttributesModel::TDriverAttributesModel(QObject *parent) :
+    QAbstractTableModel(parent),
+    cachedRow(-1)
+{
+}
+
+
+void TDriverAttributesModel::setAttributes(const QMap<QString, AttributeInfo> &attributes)
+{
+    beginResetModel();
+    this->attributes = attributes;
+    cachedRow = -1;
+    endResetModel();
+}
+
+
+void TDriverAttributesModel::clear()
+{
+    if (attributes.isEmpty()) return;
+    beginResetModel();
+    attributes.clear();
+    cachedRow = -1;
+    endResetModel();
+}
+
+
+// row must be valid
+TDriverAttributesModel::RowIterator TDriverAttributesModel::rowIterator(int row) const
+{
+    // walk from the nearest of previous row, first row and last row
+    const int last = attributes.size() - 1;
+    if (cachedRow < 0 || qAbs(row - cachedRow) > qMin(row, last - row)) {
+        if (row <= last - row) {
+            cachedRow = 0;
+            cachedIterator = attributes.constBegin();
+        }
+        else {
+            cachedRow = last;
+            cachedIterator = attributes.constEnd() - 1;
+        }
+    }
+    for (; cachedRow < row; ++cachedRow) ++cachedIterator;
+    for (; cachedRow > row; --cachedRow) --cachedIterator;
+    return cachedIterator;
+}
+
+
+// non writable attributes must not be editable - "w" or "writable"
+bool TDriverAttributesModel::isWritable(const AttributeInfo &info)
+{
+    return info.type.contains('w', Qt::CaseInsensitive);
+}
+
+
+int TDriverAttributesModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : attributes.size();
+}
+
+
+int TDriverAttributesModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : COLUMN_COUNT;
+}
+
+
+QVariant TDriverAttributesModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= attributes.size()) return QVariant();
+
+    const AttributeInfo &info = attribute(index.row());
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return (index.column() == NameColumn) ? info.name : info.value;
+
+    case Qt::BackgroundRole:
+        // paint read-only values gray
+        if (index.column() == ValueColumn && !isWritable(info)) {
+            return QBrush(Qt::lightGray);
+        }
+        break;
+
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+
+QVariant TDriverAttributesModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) return QVariant();
+
+    if (orientation == Qt::Horizontal) {
+        switch (section) {
+        case NameColumn: return tr("Name");
+        case ValueColumn: return tr("Value");
+        default: return QVariant();
+        }
+    }
+    return section + 1;
+}
+
+
+Qt::ItemFlags TDriverAttributesModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid()) return Qt::NoItemFlags;
+
+    // every cell is selectable & enabled for copying, only writable values are editable
+    Qt::ItemFlags result = Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+    if (index.column() == ValueColumn && isWritable(attribute(index.row()))) {
+        result |= Qt::ItemIsEditable;
+    }
+    return result;
+}
+
+
+bool TDriverAttributesModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (role != Qt::EditRole || !(flags(index) & Qt::ItemIsEditable)) return false;
+
+    const QString key(rowIterator(index.row()).key());
+    QString text(value.toString());
+    if (text == attributes.value(key).value) return false;
+
+    // modifying detaches the shared map, so cached iterator is not valid any more
+    AttributeInfo &info = attributes[key];
+    cachedRow = -1;
+    info.value = text;
+    const QString name(info.name);
+    emit dataChanged(index, index);
+    emit attributeEdited(name, text);
+    return true;
+}
@@ -0,0 +1,70 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#ifndef TDRIVER_ATTRIBUTESMODEL_H
+#define TDRIVER_ATTRIBUTESMODEL_H
+
+#include "tdriver_main_types.h"
+
+#include <QAbstractTableModel>
+#include <QMap>
+
+// Read-mostly table model over attributes of one test object. The attribute map is
+// shared, not copied, and views only query visible rows, so switching between objects
+// with thousands of attributes does not create per-row or per-cell data.
+class TDriverAttributesModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Column { NameColumn = 0, ValueColumn, COLUMN_COUNT };
+
+    explicit TDriverAttributesModel(QObject *parent = 0);
+
+    // replaces shown attributes, rows are in map (lowercase name) order
+    void setAttributes(const QMap<QString, AttributeInfo> &attributes);
+    void clear();
+
+    const AttributeInfo &attribute(int row) const { return rowIterator(row).value(); }
+    static bool isWritable(const AttributeInfo &info);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    Qt::ItemFlags flags(const QModelIndex &index) const;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
+
+signals:
+    // emitted when user edits value of a writable attribute
+    void attributeEdited(const QString &name, const QString &value);
+
+private:
+    typedef QMap<QString, AttributeInfo>::const_iterator RowIterator;
+    RowIterator rowIterator(int row) const;
+
+    QMap<QString, AttributeInfo> attributes;
+
+    // position of last accessed row, views ask for rows near each other
+    mutable int cachedRow;
+    mutable RowIterator cachedIterator;
+};
+
+#endif // TDRIVER_ATTRIBUTESMODEL_H
@@ -43,7 +43,7 @@ mac {
 INCLUDEPATH += $$EDITORLIBDIR
 #LIBS += -L$$EDITORLIBDIR -l$$EDITOR_LIB
 LIBS += -l$$EDITOR_LIB
-QT += network xml widgets
+QT += network xml widgets concurrent
 
 # For libtdriverfetureditor
 INCLUDEPATH += $$FEATUREDITORLIBDIR
@@ -51,7 +51,15 @@ LIBS += -l$$FEATUREDITOR_LIB
 
 # Input
 HEADERS += ../inc/tdriver_main_types.h \
-    tdriver_statehistorymenu.h
+    tdriver_statehistorymenu.h \
+    tdriver_imagediff.h \
+    tdriver_objectindex.h \
+    tdriver_findallpanel.h \
+    tdriver_objectquery.h \
+    tdriver_locatoranalyzer.h \
+    tdriver_attributesmodel.h \
+    tdriver_metadatacache.h \
+    tdriver_objecttreedelegate.h
 HEADERS += ../inc/tdriver_behaviour.h
 HEADERS += ../inc/tdriver_image_view.h
 HEADERS += ../inc/tdriver_main_window.h
@@ -59,7 +67,15 @@ HEADERS += ../inc/tdriver_recorder.h
 
 SOURCES += ../src/tdriver_libeditor_ui.cpp \
     ../src/tdriver_libfeatureditor_ui.cpp \
-    tdriver_statehistorymenu.cpp
+    tdriver_statehistorymenu.cpp \
+    tdriver_imagediff.cpp \
+    tdriver_objectindex.cpp \
+    tdriver_findallpanel.cpp \
+    tdriver_objectquery.cpp \
+    tdriver_locatoranalyzer.cpp \
+    tdriver_attributesmodel.cpp \
+    tdriver_metadatacache.cpp \
+    tdriver_objecttreedelegate.cpp
 SOURCES += ../src/tdriver_editor.cpp
 SOURCES += ../src/tdriver_main_window.cpp
 SOURCES += ../src/tdriver_image_view.cpp
@@ -76,6 +92,13 @@ SOURCES += ../src/tdriver_xml.cpp
 SOURCES += ../src/tdriver_find_dialog.cpp
 SOURCES += ../src/tdriver_startapp_dialog.cpp
 SOURCES += ../src/tdriver_savedlayouts.cpp
+SOURCES += ../src/tdriver_state_diff.cpp
+SOURCES += ../src/tdriver_object_query.cpp
+SOURCES += ../src/tdriver_metadata_cache.cpp
+SOURCES += ../src/tdriver_signal_prefetch.cpp
+SOURCES += ../src/tdriver_batch.cpp
+SOURCES += ../src/tdriver_watch.cpp
+SOURCES += ../src/tdriver_device_session.cpp
 
 FORMS += ../src/tdriver_richtextcontainer.ui
 
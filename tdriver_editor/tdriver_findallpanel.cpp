@@ -0,0 +1,225 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#include "tdriver_findallpanel.h"
+
+#include <QCheckBox>
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QStringList>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QtConcurrentRun>
+
+static const int maxShownResults = 1000;
+static const int maxShownValueLength = 100;
+
+
+static QString objectPath(const TDriverObjectIndex &index, int ordinal)
+{
+    QStringList parts;
+    for (; ordinal >= 0; ordinal = index.parent(ordinal)) {
+        const TreeItemInfo &info = index.treeData(ordinal);
+        parts.prepend(info.name.isEmpty() ? info.type : QString("%1 '%2'").arg(info.type, info.name));
+    }
+    return parts.join(" / ");
+}
+
+
+static TDriverFindAllPanel::ResultList findAllWorker(QSharedPointer<const TDriverObjectIndex> index,
+                                                     TDriverObjectIndex::Query query,
+                                                     QAtomicInt *generation, int searchGeneration)
+{
+    TDriverFindAllPanel::ResultList ret;
+    const QVector<int> candidates = index->candidates(query);
+
+    for (int ii = 0; ii < candidates.size(); ++ii) {
+        // stop if a newer search has been started
+        if ((ii & 0xff) == 0 && generation->loadAcquire() != searchGeneration) {
+            ret.results.clear();
+            ret.totalCount = 0;
+            break;
+        }
+
+        int attr;
+        const int ordinal = candidates.at(ii);
+        if (!index->matches(ordinal, query, &attr)) continue;
+
+        ++ret.totalCount;
+        if (ret.results.size() >= maxShownResults) continue;
+
+        TDriverFindAllPanel::Result result;
+        result.key = index->key(ordinal);
+        result.path = objectPath(*index, ordinal);
+        if (attr >= 0) {
+            QString value = index->attributeValue(attr);
+            if (value.size() > maxShownValueLength) value = value.left(maxShownValueLength) + "...";
+            result.match = QString("%1 = %2").arg(index->attributeName(attr), value);
+        }
+        ret.results << result;
+    }
+
+    return ret;
+}
+
+
+TDriverFindAllPanel::TDriverFindAllPanel(QWidget *parent) :
+    QWidget(parent),
+    searchDelay(new QTimer(this)),
+    watcher(new QFutureWatcher<ResultList>(this)),
+    generation(0)
+{
+    QGridLayout *layout = new QGridLayout(this);
+    layout->setObjectName("findall");
+
+    searchText = new QLineEdit();
+    searchText->setObjectName("findall text");
+    layout->addWidget(searchText, 0, 0, 1, -1);
+
+    matchCase = new QCheckBox(tr("&Match case"));
+    matchCase->setObjectName("findall matchcase");
+    layout->addWidget(matchCase, 1, 0);
+
+    entireWords = new QCheckBox(tr("Match &entire word only"));
+    entireWords->setObjectName("findall entirewords");
+    layout->addWidget(entireWords, 1, 1);
+
+    searchAttributes = new QCheckBox(tr("&Attribute values"));
+    searchAttributes->setObjectName("findall attributevalues");
+    searchAttributes->setChecked(true);
+    layout->addWidget(searchAttributes, 1, 2);
+
+    resultsView = new QTreeWidget();
+    resultsView->setObjectName("findall results");
+    resultsView->setRootIsDecorated(false);
+    resultsView->setUniformRowHeights(true);
+    resultsView->setColumnCount(2);
+    resultsView->setHeaderLabels(QStringList() << tr("Object") << tr("Matching attribute"));
+    resultsView->header()->setSectionResizeMode(QHeaderView::Interactive);
+    resultsView->header()->resizeSection(0, 300);
+    layout->addWidget(resultsView, 2, 0, 1, -1);
+
+    statusLabel = new QLabel();
+    statusLabel->setObjectName("findall status");
+    layout->addWidget(statusLabel, 3, 0, 1, -1);
+
+    // short delay lets user type several characters before searching
+    searchDelay->setSingleShot(true);
+    searchDelay->setInterval(150);
+
+    connect(searchText, SIGNAL(textChanged(QString)), this, SLOT(scheduleSearch()));
+    connect(matchCase, SIGNAL(toggled(bool)), this, SLOT(scheduleSearch()));
+    connect(entireWords, SIGNAL(toggled(bool)), this, SLOT(scheduleSearch()));
+    connect(searchAttributes, SIGNAL(toggled(bool)), this, SLOT(scheduleSearch()));
+    connect(searchDelay, SIGNAL(timeout()), this, SLOT(startSearch()));
+    connect(watcher, SIGNAL(finished()), this, SLOT(searchFinished()));
+    connect(resultsView, SIGNAL(itemActivated(QTreeWidgetItem*,int)), this, SLOT(emitActivated(QTreeWidgetItem*)));
+    connect(resultsView, SIGNAL(itemClicked(QTreeWidgetItem*,int)), this, SLOT(emitActivated(QTreeWidgetItem*)));
+}
+
+
+TDriverFindAllPanel::~TDriverFindAllPanel()
+{
+    // worker refers to generation, so it must be done before this is destroyed
+    generation.ref();
+    watcher->waitForFinished();
+}
+
+
+void TDriverFindAllPanel::setIndex(const QSharedPointer<const TDriverObjectIndex> &newIndex)
+{
+    index = newIndex;
+    startSearch();
+}
+
+
+void TDriverFindAllPanel::focusSearchText()
+{
+    searchText->setFocus();
+    searchText->selectAll();
+}
+
+
+void TDriverFindAllPanel::scheduleSearch()
+{
+    // cancel running search right away, new one starts after delay
+    generation.ref();
+    watcher->setFuture(QFuture<ResultList>());
+    searchDelay->start();
+}
+
+
+void TDriverFindAllPanel::startSearch()
+{
+    searchDelay->stop();
+    const int searchGeneration = generation.fetchAndAddOrdered(1) + 1;
+
+    resultsView->clear();
+
+    if (!index || searchText->text().isEmpty()) {
+        watcher->setFuture(QFuture<ResultList>());
+        statusLabel->clear();
+        return;
+    }
+
+    TDriverObjectIndex::Query query;
+    query.text = searchText->text();
+    query.matchCase = matchCase->isChecked();
+    query.entireWords = entireWords->isChecked();
+    query.searchAttributes = searchAttributes->isChecked();
+
+    statusLabel->setText(tr("Searching..."));
+    watcher->setFuture(QtConcurrent::run(findAllWorker, index, query, &generation, searchGeneration));
+}
+
+
+void TDriverFindAllPanel::searchFinished()
+{
+    // watcher is given an empty future to forget a cancelled search
+    if (watcher->future().resultCount() < 1) return;
+
+    const ResultList ret = watcher->result();
+    QList<QTreeWidgetItem*> items;
+
+    foreach (const Result &result, ret.results) {
+        QTreeWidgetItem *item = new QTreeWidgetItem(QStringList() << result.path << result.match);
+        item->setData(0, Qt::UserRole, testObjectKey2Str(result.key));
+        item->setToolTip(0, result.path);
+        items << item;
+    }
+    resultsView->addTopLevelItems(items);
+
+    if (ret.totalCount > ret.results.size()) {
+        statusLabel->setText(tr("%1 matches, showing first %2").arg(ret.totalCount).arg(ret.results.size()));
+    }
+    else {
+        statusLabel->setText(tr("%1 matches").arg(ret.totalCount));
+    }
+}
+
+
+void TDriverFindAllPanel::emitActivated(QTreeWidgetItem *item)
+{
+    if (!item) return;
+    TestObjectKey key = str2TestObjectKey(item->data(0, Qt::UserRole).toString());
+    if (key) emit objectActivated(key);
+}
@@ -0,0 +1,90 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#ifndef TDRIVER_FINDALLPANEL_H
+#define TDRIVER_FINDALLPANEL_H
+
+#include "tdriver_main_types.h"
+#include "tdriver_objectindex.h"
+
+#include <QWidget>
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QList>
+#include <QSharedPointer>
+
+class QCheckBox;
+class QLabel;
+class QLineEdit;
+class QTimer;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+// Lists all objects matching search text, searching in a worker thread while user types.
+class TDriverFindAllPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    struct Result {
+        TestObjectKey key;
+        QString path;
+        QString match;
+    };
+
+    struct ResultList {
+        QList<Result> results;
+        int totalCount;
+        ResultList() : totalCount(0) {}
+    };
+
+    explicit TDriverFindAllPanel(QWidget *parent = 0);
+    ~TDriverFindAllPanel();
+
+    // replaces searched snapshot and repeats current search, NULL index clears results
+    void setIndex(const QSharedPointer<const TDriverObjectIndex> &index);
+
+signals:
+    void objectActivated(TestObjectKey key);
+
+public slots:
+    void focusSearchText();
+
+private slots:
+    void scheduleSearch();
+    void startSearch();
+    void searchFinished();
+    void emitActivated(QTreeWidgetItem *item);
+
+private:
+    QLineEdit *searchText;
+    QCheckBox *matchCase;
+    QCheckBox *entireWords;
+    QCheckBox *searchAttributes;
+    QTreeWidget *resultsView;
+    QLabel *statusLabel;
+
+    QTimer *searchDelay;
+    QFutureWatcher<ResultList> *watcher;
+    QAtomicInt generation; // incremented to cancel running search
+
+    QSharedPointer<const TDriverObjectIndex> index;
+};
+
+#endif // TDRIVER_FINDALLPANEL_H
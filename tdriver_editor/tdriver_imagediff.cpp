@@ -0,0 +1,111 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#include "tdriver_imagediff.h"
+
+#include <cstring>
+
+
+static inline QImage toArgb32(const QImage &image)
+{
+    // RGB32 and ARGB32 share memory layout, but alpha byte may differ, so compare only ARGB32
+    return (image.format() == QImage::Format_ARGB32) ? image : image.convertToFormat(QImage::Format_ARGB32);
+}
+
+
+static inline bool linesDiffer(const QImage &a, const QImage &b, int left, int width, int top, int bottom)
+{
+    // memcmp is vectorized by the C library, so compare tile rows as raw memory
+    const size_t offset = size_t(left) * sizeof(QRgb);
+    const size_t bytes = size_t(width) * sizeof(QRgb);
+
+    for (int y = top; y < bottom; ++y) {
+        if (memcmp(a.constScanLine(y) + offset, b.constScanLine(y) + offset, bytes) != 0)
+            return true;
+    }
+    return false;
+}
+
+
+QList<QRect> TDriverImageDiff::changedRegions(const QImage &before, const QImage &after, int tileSize)
+{
+    QList<QRect> result;
+
+    if (after.isNull()) return result;
+
+    if (before.isNull() || before.size() != after.size()) {
+        result << after.rect();
+        return result;
+    }
+
+    if (tileSize < 1) tileSize = DEFAULT_TILE_SIZE;
+
+    const QImage a(toArgb32(before));
+    const QImage b(toArgb32(after));
+    const int width = b.width();
+    const int height = b.height();
+    const int tileCols = (width + tileSize - 1) / tileSize;
+
+    // rectangles which ended at previous tile row, and may still grow downwards
+    QList<QRect> openRects;
+
+    for (int top = 0; top < height; top += tileSize) {
+        const int bottom = qMin(top + tileSize, height);
+        QList<QRect> rowRects;
+
+        // quick check of entire tile row before checking individual tiles
+        if (linesDiffer(a, b, 0, width, top, bottom)) {
+            int spanStart = -1;
+
+            for (int col = 0; col <= tileCols; ++col) {
+                const int left = col * tileSize;
+                const bool changed = (col < tileCols
+                                      && linesDiffer(a, b, left, qMin(tileSize, width - left), top, bottom));
+
+                if (changed) {
+                    if (spanStart < 0) spanStart = col;
+                }
+                else if (spanStart >= 0) {
+                    const int spanLeft = spanStart * tileSize;
+                    rowRects << QRect(spanLeft, top, qMin(left, width) - spanLeft, bottom - top);
+                    spanStart = -1;
+                }
+            }
+        }
+
+        // continue rectangles from previous tile row, which have same horizontal extent
+        QList<QRect> stillOpen;
+        foreach (QRect rect, rowRects) {
+            for (int ii = 0; ii < openRects.size(); ++ii) {
+                if (openRects.at(ii).left() == rect.left() && openRects.at(ii).right() == rect.right()) {
+                    rect.setTop(openRects.takeAt(ii).top());
+                    break;
+                }
+            }
+            stillOpen << rect;
+        }
+
+        result << openRects;
+        openRects = stillOpen;
+    }
+
+    result << openRects;
+    return result;
+}
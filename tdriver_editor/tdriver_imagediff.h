@@ -0,0 +1,40 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#ifndef TDRIVER_IMAGEDIFF_H
+#define TDRIVER_IMAGEDIFF_H
+
+#include <QImage>
+#include <QList>
+#include <QRect>
+
+class TDriverImageDiff
+{
+public:
+    enum { DEFAULT_TILE_SIZE = 16 };
+
+    // Compares two images tile by tile, and returns rectangles covering changed tiles,
+    // in image coordinates. Adjacent changed tiles are merged to larger rectangles.
+    // If image sizes differ, entire area of after is returned as changed.
+    static QList<QRect> changedRegions(const QImage &before, const QImage &after,
+                                       int tileSize = DEFAULT_TILE_SIZE);
+};
+
+#endif // TDRIVER_IMAGEDIFF_H
@@ -0,0 +1,329 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#include "tdriver_locatoranalyzer.h"
+#include "tdriver_objectindex.h"
+
+#include <tdriver_util.h>
+
+#include <QStringList>
+#include <QFuture>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+
+
+// smaller indexes are analyzed in calling thread
+static const int parallelAnalysisMinCount = 2000;
+
+
+TDriverLocatorAnalyzer::TDriverLocatorAnalyzer(const QSharedPointer<const TDriverObjectIndex> &index) :
+    index(index)
+{
+    const int count = index->count();
+    const QVector<QPair<int, int> > ranges = independentRanges();
+    const bool parallel = (count >= parallelAnalysisMinCount && ranges.size() > 2);
+
+    // group objects by locator and by name, each range separately
+    QList<RangeGroups> rangeGroups;
+    if (parallel) {
+        QList<QFuture<RangeGroups> > futures;
+        foreach (const QPair<int, int> &range, ranges) {
+            futures << QtConcurrent::run(this, &TDriverLocatorAnalyzer::collectGroups, range);
+        }
+        foreach (QFuture<RangeGroups> future, futures) {
+            rangeGroups << future.result();
+        }
+    }
+    else {
+        foreach (const QPair<int, int> &range, ranges) {
+            rangeGroups << collectGroups(range);
+        }
+    }
+
+    // ranges are in ordinal order, so appending keeps group lists sorted
+    QHash<QString, NameGroup> names;
+    foreach (const RangeGroups &result, rangeGroups) {
+        for (int kind = 0; kind < KeyKindCount; ++kind) {
+            QHash<QString, QVector<int> >::const_iterator it;
+            for (it = result.groups[kind].constBegin(); it != result.groups[kind].constEnd(); ++it) {
+                groups[kind][it.key()] += it.value();
+            }
+        }
+
+        QHash<QString, NameGroup>::const_iterator it;
+        for (it = result.names.constBegin(); it != result.names.constEnd(); ++it) {
+            QHash<QString, NameGroup>::iterator merged = names.find(it.key());
+            if (merged == names.end()) {
+                names.insert(it.key(), it.value());
+            }
+            else {
+                merged->sameId = merged->sameId && it->sameId && merged->id == it->id;
+                merged->ordinals += it->ordinals;
+            }
+        }
+    }
+    rangeGroups.clear();
+
+    kinds.fill(-1, count);
+    anchors.fill(-1, count);
+
+    // ancestors of objects in a range are in the same range or in the first
+    // range, which is resolved before others
+    if (!ranges.isEmpty()) {
+        resolveKinds(ranges.first(), kinds.data(), anchors.data());
+    }
+    if (parallel) {
+        QList<QFuture<void> > futures;
+        for (int ii = 1; ii < ranges.size(); ++ii) {
+            futures << QtConcurrent::run(this, &TDriverLocatorAnalyzer::resolveKinds,
+                                         ranges.at(ii), kinds.data(), anchors.data());
+        }
+        foreach (QFuture<void> future, futures) {
+            future.waitForFinished();
+        }
+    }
+    else {
+        for (int ii = 1; ii < ranges.size(); ++ii) {
+            resolveKinds(ranges.at(ii), kinds.data(), anchors.data());
+        }
+    }
+
+    // duplicate object names, as shown in object tree
+    nameFlags.fill(0, count);
+    foreach (const NameGroup &group, names) {
+        if (group.ordinals.size() < 2) continue;
+
+        const quint8 flags = group.sameId ? (DuplicateName | DuplicateNameAndId) : DuplicateName;
+        foreach (int ordinal, group.ordinals) nameFlags[ordinal] = flags;
+    }
+}
+
+
+// Splits ordinals to consecutive ranges. First range is the chain of objects
+// from sut down to the first object with several children, and each child of
+// that object starts its own range, for example one per application or window.
+QVector<QPair<int, int> > TDriverLocatorAnalyzer::independentRanges() const
+{
+    QVector<QPair<int, int> > ranges;
+    const int count = index->count();
+    if (count == 0) return ranges;
+
+    int branch = 0;
+    while (branch + 1 < index->subtreeEnd(branch)
+           && index->subtreeEnd(branch + 1) == index->subtreeEnd(branch)) {
+        ++branch; // only child
+    }
+
+    ranges << qMakePair(0, branch + 1);
+    for (int child = branch + 1; child < index->subtreeEnd(branch); child = index->subtreeEnd(child)) {
+        ranges << qMakePair(child, index->subtreeEnd(child));
+    }
+
+    // objects after first top level object, not expected from ui dumps
+    if (index->subtreeEnd(0) < count) {
+        ranges << qMakePair(index->subtreeEnd(0), count);
+    }
+    return ranges;
+}
+
+
+TDriverLocatorAnalyzer::RangeGroups TDriverLocatorAnalyzer::collectGroups(QPair<int, int> range) const
+{
+    RangeGroups result;
+
+    // sut (object without parent) has its own locator, and is not analyzed
+    for (int ordinal = range.first; ordinal < range.second; ++ordinal) {
+        if (index->parent(ordinal) < 0) continue;
+
+        // object goes to every group whose locator matches it, not only the kinds it
+        // would use itself, so that uniqueness counts also objects preferring other kinds
+        result.groups[NameKey][groupKey(ordinal, NameKey)] << ordinal;
+        if (!objectText(ordinal).isEmpty()) {
+            result.groups[NameTextKey][groupKey(ordinal, NameTextKey)] << ordinal;
+            result.groups[TextKey][groupKey(ordinal, TextKey)] << ordinal;
+        }
+
+        const TreeItemInfo &info = index->treeData(ordinal);
+        if (info.name.isEmpty()) continue;
+
+        NameGroup &group = result.names[info.name];
+        if (group.ordinals.isEmpty()) group.id = info.id;
+        else if (group.id != info.id) group.sameId = false;
+        group.ordinals << ordinal;
+    }
+    return result;
+}
+
+
+// writes kinds and anchors of objects in range, reading only results of their ancestors
+void TDriverLocatorAnalyzer::resolveKinds(QPair<int, int> range, qint8 *kindData, int *anchorData) const
+{
+    for (int ordinal = range.first; ordinal < range.second; ++ordinal) {
+        if (index->parent(ordinal) < 0) continue;
+
+        kindData[ordinal] = uniqueKind(ordinal, -1);
+        if (kindData[ordinal] >= 0) continue;
+
+        for (int anchor = index->parent(ordinal); index->parent(anchor) >= 0; anchor = index->parent(anchor)) {
+            if (kindData[anchor] < 0 || anchorData[anchor] >= 0) continue;
+
+            int kind = uniqueKind(ordinal, anchor);
+            if (kind >= 0) {
+                kindData[ordinal] = kind;
+                anchorData[ordinal] = anchor;
+                break;
+            }
+        }
+    }
+}
+
+
+QString TDriverLocatorAnalyzer::objectName(int ordinal) const
+{
+    const QString &name = index->treeData(ordinal).name;
+    return (name == "NoName") ? QString() : name;
+}
+
+
+QString TDriverLocatorAnalyzer::objectText(int ordinal) const
+{
+    int attr = index->findAttribute(ordinal, "text");
+    return (attr >= 0) ? index->attributeValue(attr) : QString();
+}
+
+
+QString TDriverLocatorAnalyzer::groupKey(int ordinal, int kind) const
+{
+    static const QChar separator(0);
+    const QString &type = index->treeData(ordinal).type;
+
+    switch (kind) {
+    case NameKey: return type + separator + objectName(ordinal);
+    case NameTextKey: return type + separator + objectName(ordinal) + separator + objectText(ordinal);
+    case TextKey: return type + separator + objectText(ordinal);
+    }
+    return QString();
+}
+
+
+// locator kinds applicable to object, in order of preference
+QVector<int> TDriverLocatorAnalyzer::kindsToTry(int ordinal) const
+{
+    QVector<int> result;
+    const bool hasText = !objectText(ordinal).isEmpty();
+
+    if (!objectName(ordinal).isEmpty()) {
+        result << NameKey;
+        if (hasText) result << NameTextKey;
+    }
+    else if (hasText) {
+        result << TextKey << NameTextKey;
+    }
+    else {
+        result << NameKey; // :name => ''
+    }
+    return result;
+}
+
+
+// returns first kind of locator matching only ordinal under scope, or -1
+int TDriverLocatorAnalyzer::uniqueKind(int ordinal, int scope) const
+{
+    foreach (int kind, kindsToTry(ordinal)) {
+        const QVector<int> group = groups[kind].value(groupKey(ordinal, kind));
+        if (scope < 0) {
+            if (group.size() == 1) return kind;
+        }
+        else {
+            QVector<int>::const_iterator first = std::upper_bound(group.constBegin(), group.constEnd(), scope);
+            QVector<int>::const_iterator last = std::lower_bound(first, group.constEnd(), index->subtreeEnd(scope));
+            if (last - first == 1) return kind;
+        }
+    }
+    return -1;
+}
+
+
+// position of ordinal among objects matching same locator under scope, in document order
+int TDriverLocatorAnalyzer::indexInScope(int ordinal, int kind, int scope) const
+{
+    const QVector<int> group = groups[kind].value(groupKey(ordinal, kind));
+    QVector<int>::const_iterator first = (scope < 0)
+            ? group.constBegin()
+            : std::upper_bound(group.constBegin(), group.constEnd(), scope);
+    return int(std::lower_bound(first, group.constEnd(), ordinal) - first);
+}
+
+
+QString TDriverLocatorAnalyzer::segmentText(int ordinal, int kind, int position) const
+{
+    QStringList params;
+
+    switch (kind) {
+    case NameKey:
+        params << ":name => " + TDriverUtil::rubySingleQuote(objectName(ordinal));
+        break;
+    case NameTextKey:
+        params << ":name => " + TDriverUtil::rubySingleQuote(objectName(ordinal))
+               << ":text => " + TDriverUtil::rubySingleQuote(objectText(ordinal));
+        break;
+    case TextKey:
+        params << ":text => " + TDriverUtil::rubySingleQuote(objectText(ordinal));
+        break;
+    }
+
+    if (position >= 0) params << QString(":__index => %1").arg(position);
+
+    return index->treeData(ordinal).type + "( " + params.join(", ") + " )";
+}
+
+
+QString TDriverLocatorAnalyzer::locator(int ordinal) const
+{
+    const int kind = kinds.at(ordinal);
+    const int anchor = anchors.at(ordinal);
+
+    if (kind < 0) {
+        // locator is evaluated under application of the object, so index is counted there
+        int scope = index->parent(ordinal);
+        while (scope >= 0 && index->parent(scope) >= 0 && index->parent(index->parent(scope)) >= 0) {
+            scope = index->parent(scope);
+        }
+        const int fallbackKind = kindsToTry(ordinal).first();
+        return segmentText(ordinal, fallbackKind, indexInScope(ordinal, fallbackKind, scope));
+    }
+    else if (anchor >= 0) {
+        return segmentText(anchor, kinds.at(anchor)) + "." + segmentText(ordinal, kind);
+    }
+    else {
+        return segmentText(ordinal, kind);
+    }
+}
+
+
+QString TDriverLocatorAnalyzer::segment(int ordinal, int scope) const
+{
+    const int kind = uniqueKind(ordinal, scope);
+    if (kind >= 0) return segmentText(ordinal, kind);
+
+    const int fallbackKind = kindsToTry(ordinal).first();
+    return segmentText(ordinal, fallbackKind, indexInScope(ordinal, fallbackKind, scope));
+}
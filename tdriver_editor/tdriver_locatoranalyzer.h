@@ -0,0 +1,92 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#ifndef TDRIVER_LOCATORANALYZER_H
+#define TDRIVER_LOCATORANALYZER_H
+
+#include <QHash>
+#include <QPair>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+class TDriverObjectIndex;
+
+// Finds Ruby locators which resolve to exactly one object in an object index.
+// Locator is the first unique one of Type( :name ), Type( :name, :text ) and Type( :text ),
+// then the same prefixed with a uniquely located ancestor, and as last resort
+// Type( ..., :__index => n ).
+class TDriverLocatorAnalyzer
+{
+public:
+    explicit TDriverLocatorAnalyzer(const QSharedPointer<const TDriverObjectIndex> &index);
+
+    // locator unique in entire index
+    QString locator(int ordinal) const;
+    bool locatorNeedsIndex(int ordinal) const { return kinds.at(ordinal) < 0; }
+
+    // locator segment unique among descendants of scope, scope -1 means entire index
+    QString segment(int ordinal, int scope) const;
+
+    // other objects with same object name, ignoring type
+    bool hasDuplicateName(int ordinal) const { return nameFlags.at(ordinal) & DuplicateName; }
+    bool hasDuplicateNameAndId(int ordinal) const { return nameFlags.at(ordinal) & DuplicateNameAndId; }
+
+private:
+    enum KeyKind { NameKey, NameTextKey, TextKey, KeyKindCount };
+    enum NameFlag { DuplicateName = 0x1, DuplicateNameAndId = 0x2 };
+
+    // objects with same name, and whether they all have same id
+    struct NameGroup {
+        QVector<int> ordinals;
+        QString id;
+        bool sameId;
+        NameGroup() : sameId(true) {}
+    };
+
+    // groups found in one range of ordinals, merged after all ranges are done
+    struct RangeGroups {
+        QHash<QString, QVector<int> > groups[KeyKindCount];
+        QHash<QString, NameGroup> names;
+    };
+
+    QVector<QPair<int, int> > independentRanges() const;
+    RangeGroups collectGroups(QPair<int, int> range) const;
+    void resolveKinds(QPair<int, int> range, qint8 *kindData, int *anchorData) const;
+
+    QString objectName(int ordinal) const;
+    QString objectText(int ordinal) const;
+    QString groupKey(int ordinal, int kind) const;
+    QVector<int> kindsToTry(int ordinal) const;
+    int uniqueKind(int ordinal, int scope) const;
+    int indexInScope(int ordinal, int kind, int scope) const;
+    QString segmentText(int ordinal, int kind, int index = -1) const;
+
+    QSharedPointer<const TDriverObjectIndex> index;
+
+    // objects matched by each kind of locator, sorted
+    QHash<QString, QVector<int> > groups[KeyKindCount];
+
+    QVector<qint8> kinds; // KeyKind of unique locator, -1 if :__index is needed
+    QVector<int> anchors; // uniquely located ancestor prefixed to locator, or -1
+    QVector<quint8> nameFlags;
+};
+
+#endif // TDRIVER_LOCATORANALYZER_H
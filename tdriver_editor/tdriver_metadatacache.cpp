@@ -0,0 +1,116 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#include "tdriver_metadatacache.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <QRegExp>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "tdriver_debug_macros.h"
+
+static const quint32 cacheMagic = 0x54445643; // "TDVC"
+static const quint32 cacheFormatVersion = 2;
+
+
+static QString fileNamePart(QString text)
+{
+    return text.trimmed().replace(QRegExp("[^A-Za-z0-9._-]"), "_");
+}
+
+
+QString TDriverMetadataCache::fileName(const QString &tdriverVersion, const QString &sutType)
+{
+    if (tdriverVersion.isEmpty() || tdriverVersion == "Unknown" || sutType.isEmpty()) {
+        return QString();
+    }
+
+    QString dirPath(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    if (dirPath.isEmpty()) return QString();
+
+    return dirPath + "/metadata_" + fileNamePart(sutType) + "_" + fileNamePart(tdriverVersion) + ".cache";
+}
+
+
+bool TDriverMetadataCache::read(const QString &fileName, BehaviourMap &behaviours,
+                                SignalMap &signalLists, ApiMethodMap &apiMethods)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 formatVersion = 0;
+    in >> magic >> formatVersion;
+
+    if (magic != cacheMagic || formatVersion != cacheFormatVersion) {
+        qDebug() << FCFL << "ignoring incompatible cache file" << fileName;
+        return false;
+    }
+    in.setVersion(QDataStream::Qt_5_0);
+
+    BehaviourMap readBehaviours;
+    SignalMap readSignals;
+    ApiMethodMap readApiMethods;
+    in >> readBehaviours >> readSignals >> readApiMethods;
+
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << FCFL << "corrupted cache file" << fileName;
+        return false;
+    }
+
+    behaviours.swap(readBehaviours);
+    signalLists.swap(readSignals);
+    apiMethods.swap(readApiMethods);
+    qDebug() << FCFL << "read" << behaviours.size() << "behaviours and" << signalLists.size()
+             << "signal lists from" << fileName;
+    return true;
+}
+
+
+bool TDriverMetadataCache::write(const QString &fileName, const BehaviourMap &behaviours,
+                                 const SignalMap &signalLists, const ApiMethodMap &apiMethods)
+{
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    // old cache is replaced only after new one is completely written
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << FCFL << "failed to open" << fileName;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out << cacheMagic << cacheFormatVersion;
+    out.setVersion(QDataStream::Qt_5_0);
+    out << behaviours << signalLists << apiMethods;
+
+    if (out.status() != QDataStream::Ok) file.cancelWriting();
+    if (!file.commit()) {
+        qDebug() << FCFL << "failed to write" << fileName << file.errorString();
+        return false;
+    }
+    return true;
+}
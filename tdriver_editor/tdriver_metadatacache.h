@@ -0,0 +1,54 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+#ifndef TDRIVER_METADATACACHE_H
+#define TDRIVER_METADATACACHE_H
+
+#include "tdriver_behaviour.h"
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+// Persists object type metadata (behaviours, signals and api methods) between
+// sessions. There is one cache file per cuTeDriver version and SUT type, and
+// data inside a file is keyed by object type.
+class TDriverMetadataCache
+{
+public:
+    typedef QMap<QString, Behaviour> BehaviourMap;
+    typedef QHash<QString, QStringList> SignalMap;
+    typedef QHash<QString, QMap<QString, QHash<QString, QString> > > ApiMethodMap;
+
+    // returns cache file path, or empty string if version or SUT type is unknown
+    static QString fileName(const QString &tdriverVersion, const QString &sutType);
+
+    // returns false if file does not exist or was written by incompatible version,
+    // in which case maps are left untouched
+    static bool read(const QString &fileName, BehaviourMap &behaviours,
+                     SignalMap &signalLists, ApiMethodMap &apiMethods);
+
+    static bool write(const QString &fileName, const BehaviourMap &behaviours,
+                      const SignalMap &signalLists, const ApiMethodMap &apiMethods);
+};
+
+#endif // TDRIVER_METADATACACHE_H
@@ -0,0 +1,300 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#include "tdriver_objectindex.h"
+
+#include <QTreeWidgetItem>
+
+#include <algorithm>
+#include <iterator>
+
+// longer attribute values (for example long texts) are verified without using trigrams
+static const int maxTrigramIndexedLength = 256;
+
+
+static inline quint64 trigramAt(const QChar *p)
+{
+    return (quint64(p[0].unicode()) << 32) | (quint64(p[1].unicode()) << 16) | quint64(p[2].unicode());
+}
+
+
+static inline void addPosting(QVector<int> &list, int ordinal)
+{
+    // ordinals are added in increasing order, so lists stay sorted
+    if (list.isEmpty() || list.last() != ordinal) list.append(ordinal);
+}
+
+
+static void addTrigrams(QHash<quint64, QVector<int> > &index, const QString &folded, int ordinal)
+{
+    const QChar *p = folded.constData();
+    for (int ii = 0; ii + 3 <= folded.size(); ++ii) {
+        addPosting(index[trigramAt(p + ii)], ordinal);
+    }
+}
+
+
+static inline bool shorterList(const QVector<int> *a, const QVector<int> *b)
+{
+    return a->size() < b->size();
+}
+
+
+static QVector<int> intersectTrigrams(const QHash<quint64, QVector<int> > &index, const QString &folded)
+{
+    QList<const QVector<int> *> lists;
+    const QChar *p = folded.constData();
+
+    for (int ii = 0; ii + 3 <= folded.size(); ++ii) {
+        QHash<quint64, QVector<int> >::const_iterator it = index.constFind(trigramAt(p + ii));
+        if (it == index.constEnd()) return QVector<int>();
+        lists << &it.value();
+    }
+
+    // start from the shortest list to keep intermediate results small
+    std::sort(lists.begin(), lists.end(), shorterList);
+
+    QVector<int> result = *lists.first();
+    for (int ii = 1; ii < lists.size() && !result.isEmpty(); ++ii) {
+        QVector<int> next;
+        std::set_intersection(result.constBegin(), result.constEnd(),
+                              lists.at(ii)->constBegin(), lists.at(ii)->constEnd(),
+                              std::back_inserter(next));
+        result = next;
+    }
+    return result;
+}
+
+
+static QVector<int> uniteLists(const QVector<int> &a, const QVector<int> &b)
+{
+    if (a.isEmpty()) return b;
+    if (b.isEmpty()) return a;
+
+    QVector<int> result;
+    result.reserve(a.size() + b.size());
+    std::set_union(a.constBegin(), a.constEnd(), b.constBegin(), b.constEnd(), std::back_inserter(result));
+    return result;
+}
+
+
+static inline QString attributeValueKey(const QString &lowerName, const QString &value)
+{
+    return lowerName + QChar(0) + value;
+}
+
+
+static inline bool matchText(const QString &value, const TDriverObjectIndex::Query &query)
+{
+    Qt::CaseSensitivity caseSensitivity = query.matchCase ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    return query.entireWords
+            ? (value.compare(query.text, caseSensitivity) == 0)
+            : value.contains(query.text, caseSensitivity);
+}
+
+
+TDriverObjectIndex::TDriverObjectIndex()
+{
+    attrBegins << 0;
+}
+
+
+void TDriverObjectIndex::build(QTreeWidgetItem *root,
+                               const TestObjectArray<TreeItemInfo> &treeData,
+                               const TestObjectArray<QMap<QString, AttributeInfo> > &attributes)
+{
+    if (!root) return;
+
+    for (int ii = 0; ii < root->childCount(); ++ii) {
+        addSubtree(root->child(ii), -1, treeData, attributes);
+    }
+}
+
+
+void TDriverObjectIndex::addSubtree(QTreeWidgetItem *item, int parentOrdinal,
+                                    const TestObjectArray<TreeItemInfo> &treeData,
+                                    const TestObjectArray<QMap<QString, AttributeInfo> > &attributes)
+{
+    const int ordinal = keys.size();
+    const TestObjectKey itemKey = ptr2TestObjectKey(item);
+
+    keys << itemKey;
+    parents << parentOrdinal;
+    subtreeEnds << ordinal + 1;
+    infos << treeData.value(itemKey);
+    if (itemKey >= TestObjectKey(ordinals.size())) {
+        const int oldSize = ordinals.size();
+        ordinals.resize(itemKey + 1);
+        std::fill(ordinals.begin() + oldSize, ordinals.end(), -1);
+    }
+    ordinals[itemKey] = ordinal;
+
+    const TreeItemInfo &info = infos.last();
+    addField(info.type, ordinal);
+    addField(info.name, ordinal);
+    addField(info.id, ordinal);
+    if (!info.type.isEmpty()) addPosting(typeObjects[info.type], ordinal);
+    if (!info.name.isEmpty()) addPosting(nameObjects[info.name], ordinal);
+
+    const QMap<QString, AttributeInfo> &itemAttributes = attributes.value(itemKey);
+    QMap<QString, AttributeInfo>::const_iterator it;
+
+    for (it = itemAttributes.constBegin(); it != itemAttributes.constEnd(); ++it) {
+        const QString &value = it.value().value;
+        attrKeys << it.key();
+        attrNames << it.value().name;
+        attrValues << value;
+
+        addPosting(attributeObjects[it.key()], ordinal);
+        addPosting(attributeValueObjects[attributeValueKey(it.key(), value)], ordinal);
+
+        if (value.isEmpty()) continue;
+
+        const QString folded = value.toCaseFolded();
+        addPosting(attributeValues[folded], ordinal);
+
+        if (folded.size() > maxTrigramIndexedLength) addPosting(longAttributes, ordinal);
+        else addTrigrams(attributeTrigrams, folded, ordinal);
+    }
+    attrBegins << attrNames.size();
+
+    for (int ii = 0; ii < item->childCount(); ++ii) {
+        addSubtree(item->child(ii), ordinal, treeData, attributes);
+    }
+
+    subtreeEnds[ordinal] = keys.size();
+}
+
+
+void TDriverObjectIndex::addField(const QString &text, int ordinal)
+{
+    if (text.isEmpty()) return;
+
+    const QString folded = text.toCaseFolded();
+    addPosting(fieldValues[folded], ordinal);
+    addTrigrams(fieldTrigrams, folded, ordinal);
+}
+
+
+int TDriverObjectIndex::findAttribute(int ordinal, const QString &lowerName) const
+{
+    QVector<QString>::const_iterator begin = attrKeys.constBegin() + attrBegins.at(ordinal);
+    QVector<QString>::const_iterator end = attrKeys.constBegin() + attrBegins.at(ordinal + 1);
+    QVector<QString>::const_iterator it = std::lower_bound(begin, end, lowerName);
+
+    return (it != end && *it == lowerName) ? int(it - attrKeys.constBegin()) : -1;
+}
+
+
+QVector<int> TDriverObjectIndex::objectsWithAttributeValue(const QString &lowerName, const QString &value) const
+{
+    return attributeValueObjects.value(attributeValueKey(lowerName, value));
+}
+
+
+QVector<int> TDriverObjectIndex::candidates(const Query &query) const
+{
+    QVector<int> result;
+    const QString folded = query.text.toCaseFolded();
+
+    if (folded.isEmpty()) return result;
+
+    if (query.entireWords) {
+        result = fieldValues.value(folded);
+        if (query.searchAttributes) result = uniteLists(result, attributeValues.value(folded));
+    }
+    else if (folded.size() < 3) {
+        // too short for trigrams, every object is a candidate
+        result.resize(count());
+        for (int ii = 0; ii < result.size(); ++ii) result[ii] = ii;
+    }
+    else {
+        result = intersectTrigrams(fieldTrigrams, folded);
+        if (query.searchAttributes) {
+            result = uniteLists(result, intersectTrigrams(attributeTrigrams, folded));
+            result = uniteLists(result, longAttributes);
+        }
+    }
+
+    return result;
+}
+
+
+bool TDriverObjectIndex::matches(int ordinal, const Query &query, int *matchingAttribute) const
+{
+    if (matchingAttribute) *matchingAttribute = -1;
+
+    const TreeItemInfo &info = infos.at(ordinal);
+    if (matchText(info.name, query) || matchText(info.type, query) || matchText(info.id, query)) {
+        return true;
+    }
+
+    if (query.searchAttributes) {
+        for (int ii = attrBegins.at(ordinal); ii < attrBegins.at(ordinal + 1); ++ii) {
+            if (matchText(attrValues.at(ii), query)) {
+                if (matchingAttribute) *matchingAttribute = ii;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+int TDriverObjectIndex::findNext(const Query &query, int current, int root, bool backwards, bool wrap) const
+{
+    if (root < 0 || root >= count()) return -1;
+
+    const int end = subtreeEnds.at(root);
+    const QVector<int> list = candidates(query);
+    QVector<int>::const_iterator first = std::lower_bound(list.constBegin(), list.constEnd(), root);
+    QVector<int>::const_iterator last = std::lower_bound(first, list.constEnd(), end);
+    QVector<int>::const_iterator it;
+
+    // without valid current, search starts from subtree start (or end)
+    if (current < root || current >= end) current = backwards ? end : root - 1;
+
+    if (!backwards) {
+        for (it = std::upper_bound(first, last, current); it != last; ++it) {
+            if (matches(*it, query)) return *it;
+        }
+        if (wrap) {
+            for (it = first; it != last && *it <= current; ++it) {
+                if (matches(*it, query)) return *it;
+            }
+        }
+    }
+    else {
+        QVector<int>::const_iterator stop = std::lower_bound(first, last, current);
+        for (it = stop; it != first; ) {
+            --it;
+            if (matches(*it, query)) return *it;
+        }
+        if (wrap) {
+            for (it = last; it != stop; ) {
+                --it;
+                if (matches(*it, query)) return *it;
+            }
+        }
+    }
+
+    return -1;
+}
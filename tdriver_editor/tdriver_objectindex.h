@@ -0,0 +1,117 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#ifndef TDRIVER_OBJECTINDEX_H
+#define TDRIVER_OBJECTINDEX_H
+
+#include "tdriver_main_types.h"
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+class QTreeWidgetItem;
+
+// Search index of the object tree, built after ui dump is loaded.
+// Objects are identified by their pre-order position ("ordinal") in the tree,
+// so subtree of an object is the ordinal range [ordinal, subtreeEnd(ordinal)).
+// Index is not modified after build(), so it can be searched from any thread.
+class TDriverObjectIndex
+{
+public:
+    struct Query {
+        QString text;
+        bool matchCase;
+        bool entireWords;
+        bool searchAttributes;
+        Query() : matchCase(false), entireWords(false), searchAttributes(true) {}
+    };
+
+    TDriverObjectIndex();
+
+    // indexes children of root and their descendants
+    void build(QTreeWidgetItem *root,
+               const TestObjectArray<TreeItemInfo> &treeData,
+               const TestObjectArray<QMap<QString, AttributeInfo> > &attributes);
+
+    int count() const { return keys.size(); }
+    int ordinal(TestObjectKey key) const { return (key < TestObjectKey(ordinals.size())) ? ordinals.at(key) : -1; }
+    TestObjectKey key(int ordinal) const { return keys.at(ordinal); }
+    int parent(int ordinal) const { return parents.at(ordinal); }
+    int subtreeEnd(int ordinal) const { return subtreeEnds.at(ordinal); }
+    const TreeItemInfo &treeData(int ordinal) const { return infos.at(ordinal); }
+
+    // attributes of object are indexes [attributeBegin(ordinal), attributeBegin(ordinal+1)),
+    // sorted by lower case name
+    int attributeBegin(int ordinal) const { return attrBegins.at(ordinal); }
+    const QString &attributeName(int index) const { return attrNames.at(index); }
+    const QString &attributeValue(int index) const { return attrValues.at(index); }
+    int findAttribute(int ordinal, const QString &lowerName) const;
+
+    // exact lookups, returning sorted ordinals
+    QVector<int> objectsOfType(const QString &type) const { return typeObjects.value(type); }
+    QVector<int> objectsWithName(const QString &name) const { return nameObjects.value(name); }
+    QVector<int> objectsWithAttribute(const QString &lowerName) const { return attributeObjects.value(lowerName); }
+    QVector<int> objectsWithAttributeValue(const QString &lowerName, const QString &value) const;
+
+    // sorted ordinals of objects which may match query, verify with matches()
+    QVector<int> candidates(const Query &query) const;
+
+    // matchingAttribute is set to index of matching attribute, or -1 if tree data matched
+    bool matches(int ordinal, const Query &query, int *matchingAttribute = NULL) const;
+
+    // next (or previous) match from current inside subtree of root, or -1 if none
+    int findNext(const Query &query, int current, int root, bool backwards, bool wrap) const;
+
+private:
+    void addSubtree(QTreeWidgetItem *item, int parentOrdinal,
+                    const TestObjectArray<TreeItemInfo> &treeData,
+                    const TestObjectArray<QMap<QString, AttributeInfo> > &attributes);
+    void addField(const QString &text, int ordinal);
+
+    QVector<TestObjectKey> keys;
+    QVector<int> parents;
+    QVector<int> subtreeEnds;
+    QVector<TreeItemInfo> infos;
+    QVector<int> ordinals; // indexed by key, -1 if not indexed
+
+    QVector<int> attrBegins;
+    QVector<QString> attrKeys;
+    QVector<QString> attrNames;
+    QVector<QString> attrValues;
+
+    // exact type, name, attribute name and attribute name+value, mapped to sorted ordinals
+    QHash<QString, QVector<int> > typeObjects;
+    QHash<QString, QVector<int> > nameObjects;
+    QHash<QString, QVector<int> > attributeObjects;
+    QHash<QString, QVector<int> > attributeValueObjects;
+
+    // case folded values and their trigrams, mapped to sorted ordinals
+    QHash<QString, QVector<int> > fieldValues;
+    QHash<QString, QVector<int> > attributeValues;
+    QHash<quint64, QVector<int> > fieldTrigrams;
+    QHash<quint64, QVector<int> > attributeTrigrams;
+
+    // objects with attribute values too long for trigram index, always candidates
+    QVector<int> longAttributes;
+};
+
+#endif // TDRIVER_OBJECTINDEX_H
@@ -0,0 +1,457 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#include "tdriver_objectquery.h"
+#include "tdriver_objectindex.h"
+
+#include <QBitArray>
+#include <QPair>
+
+#include <algorithm>
+#include <iterator>
+
+
+static QVector<int> intersectLists(const QVector<int> &a, const QVector<int> &b)
+{
+    QVector<int> result;
+    std::set_intersection(a.constBegin(), a.constEnd(), b.constBegin(), b.constEnd(), std::back_inserter(result));
+    return result;
+}
+
+
+static QVector<int> uniteLists(const QVector<int> &a, const QVector<int> &b)
+{
+    if (a.isEmpty()) return b;
+    if (b.isEmpty()) return a;
+
+    QVector<int> result;
+    result.reserve(a.size() + b.size());
+    std::set_union(a.constBegin(), a.constEnd(), b.constBegin(), b.constEnd(), std::back_inserter(result));
+    return result;
+}
+
+
+static inline bool isTreeField(const QString &lowerName)
+{
+    return (lowerName == QLatin1String("name")
+            || lowerName == QLatin1String("type")
+            || lowerName == QLatin1String("id"));
+}
+
+
+// attribute value, or object tree data for name, type and id if there is no attribute
+static bool objectValue(const TDriverObjectIndex &index, int ordinal, const QString &lowerName, QString &value)
+{
+    int attr = index.findAttribute(ordinal, lowerName);
+    if (attr >= 0) {
+        value = index.attributeValue(attr);
+        return true;
+    }
+
+    const TreeItemInfo &info = index.treeData(ordinal);
+    if (lowerName == QLatin1String("name")) value = info.name;
+    else if (lowerName == QLatin1String("type")) value = info.type;
+    else if (lowerName == QLatin1String("id")) value = info.id;
+    else return false;
+
+    return !value.isEmpty();
+}
+
+
+static inline bool isNameChar(QChar ch)
+{
+    return ch.isLetterOrNumber() || ch == '_' || ch == '-' || ch == ':' || ch == '.';
+}
+
+
+TDriverObjectQuery::TDriverObjectQuery() :
+    pos(0)
+{
+}
+
+
+bool TDriverObjectQuery::parse(const QString &query)
+{
+    steps.clear();
+    error.clear();
+    text = query;
+    pos = 0;
+
+    skipSpace();
+    if (pos >= text.size()) return fail(tr("Empty query"));
+
+    while (pos < text.size()) {
+        if (!parseStep()) {
+            steps.clear();
+            return false;
+        }
+        skipSpace();
+    }
+
+    return true;
+}
+
+
+QString TDriverObjectQuery::quoted(const QString &value)
+{
+    if (!value.contains('\'')) return '\'' + value + '\'';
+    if (!value.contains('"')) return '"' + value + '"';
+    return QString();
+}
+
+
+bool TDriverObjectQuery::parseStep()
+{
+    Step step;
+
+    if (accept("//")) step.descendant = true;
+    else if (accept("/")) step.descendant = false;
+    else if (steps.isEmpty()) step.descendant = true; // no leading slash searches everywhere
+    else return fail(tr("Expected / or // at position %1").arg(pos + 1));
+
+    skipSpace();
+    if (!accept("*")) {
+        step.type = parseName();
+        if (step.type.isEmpty()) return fail(tr("Expected object type or * at position %1").arg(pos + 1));
+    }
+
+    skipSpace();
+    while (accept("[")) {
+        ExprPtr expr = parseOr();
+        if (!expr) return false;
+        skipSpace();
+        if (!accept("]")) return fail(tr("Expected ] at position %1").arg(pos + 1));
+        step.predicates << expr;
+        skipSpace();
+    }
+
+    steps << step;
+    return true;
+}
+
+
+TDriverObjectQuery::ExprPtr TDriverObjectQuery::parseOr()
+{
+    ExprPtr left = parseAnd();
+
+    while (left && acceptKeyword("or")) {
+        ExprPtr right = parseAnd();
+        if (!right) return right;
+
+        ExprPtr expr(new Expr);
+        expr->kind = Expr::Or;
+        expr->left = left;
+        expr->right = right;
+        left = expr;
+    }
+    return left;
+}
+
+
+TDriverObjectQuery::ExprPtr TDriverObjectQuery::parseAnd()
+{
+    ExprPtr left = parsePrimary();
+
+    while (left && acceptKeyword("and")) {
+        ExprPtr right = parsePrimary();
+        if (!right) return right;
+
+        ExprPtr expr(new Expr);
+        expr->kind = Expr::And;
+        expr->left = left;
+        expr->right = right;
+        left = expr;
+    }
+    return left;
+}
+
+
+TDriverObjectQuery::ExprPtr TDriverObjectQuery::parsePrimary()
+{
+    skipSpace();
+
+    if (accept("(")) {
+        ExprPtr expr = parseOr();
+        if (!expr) return expr;
+        skipSpace();
+        if (!accept(")")) {
+            fail(tr("Expected ) at position %1").arg(pos + 1));
+            return ExprPtr();
+        }
+        return expr;
+    }
+
+    if (!accept("@")) {
+        fail(tr("Expected @attribute or ( at position %1").arg(pos + 1));
+        return ExprPtr();
+    }
+
+    ExprPtr expr(new Expr);
+    expr->name = parseName().toLower();
+    if (expr->name.isEmpty()) {
+        fail(tr("Expected attribute name at position %1").arg(pos + 1));
+        return ExprPtr();
+    }
+
+    skipSpace();
+    if (accept("!=")) expr->kind = Expr::NotEquals;
+    else if (accept("~=")) expr->kind = Expr::Contains;
+    else if (accept("=")) expr->kind = Expr::Equals;
+    else {
+        expr->kind = Expr::Exists;
+        return expr;
+    }
+
+    skipSpace();
+    if (pos >= text.size() || (text.at(pos) != '\'' && text.at(pos) != '"')) {
+        fail(tr("Expected quoted value at position %1").arg(pos + 1));
+        return ExprPtr();
+    }
+
+    const QChar quote = text.at(pos++);
+    int end = text.indexOf(quote, pos);
+    if (end < 0) {
+        fail(tr("Unterminated value starting at position %1").arg(pos));
+        return ExprPtr();
+    }
+
+    expr->value = text.mid(pos, end - pos);
+    pos = end + 1;
+    return expr;
+}
+
+
+QString TDriverObjectQuery::parseName()
+{
+    int start = pos;
+    while (pos < text.size() && isNameChar(text.at(pos))) ++pos;
+    return text.mid(start, pos - start);
+}
+
+
+void TDriverObjectQuery::skipSpace()
+{
+    while (pos < text.size() && text.at(pos).isSpace()) ++pos;
+}
+
+
+bool TDriverObjectQuery::accept(const QString &token)
+{
+    if (text.mid(pos, token.size()) != token) return false;
+    pos += token.size();
+    return true;
+}
+
+
+bool TDriverObjectQuery::acceptKeyword(const QString &keyword)
+{
+    skipSpace();
+    const int end = pos + keyword.size();
+    if (text.mid(pos, keyword.size()) != keyword) return false;
+    if (end < text.size() && isNameChar(text.at(end))) return false;
+    pos = end;
+    return true;
+}
+
+
+bool TDriverObjectQuery::fail(const QString &message)
+{
+    if (error.isEmpty()) error = message;
+    return false;
+}
+
+
+// Gets superset of objects matching expr from index into result,
+// returns false if index can't be used for expr.
+bool TDriverObjectQuery::indexCandidates(const TDriverObjectIndex &index, const ExprPtr &expr, QVector<int> &result)
+{
+    switch (expr->kind) {
+
+    case Expr::Exists:
+        if (isTreeField(expr->name)) return false;
+        result = index.objectsWithAttribute(expr->name);
+        return true;
+
+    case Expr::Equals:
+        result = index.objectsWithAttributeValue(expr->name, expr->value);
+        if (expr->name == QLatin1String("type")) {
+            result = uniteLists(result, index.objectsOfType(expr->value));
+        }
+        else if (expr->name == QLatin1String("name")) {
+            result = uniteLists(result, index.objectsWithName(expr->value));
+        }
+        else if (expr->name == QLatin1String("id")) {
+            TDriverObjectIndex::Query query;
+            query.text = expr->value;
+            query.entireWords = true;
+            query.searchAttributes = false;
+            result = uniteLists(result, index.candidates(query));
+        }
+        return true;
+
+    case Expr::Contains:
+        if (expr->value.isEmpty()) return false;
+        {
+            TDriverObjectIndex::Query query;
+            query.text = expr->value;
+            result = index.candidates(query);
+        }
+        return true;
+
+    case Expr::NotEquals:
+        return false;
+
+    case Expr::And: {
+        QVector<int> left, right;
+        bool leftIndexed = indexCandidates(index, expr->left, left);
+        bool rightIndexed = indexCandidates(index, expr->right, right);
+        if (leftIndexed && rightIndexed) result = intersectLists(left, right);
+        else if (leftIndexed) result = left;
+        else if (rightIndexed) result = right;
+        else return false;
+        return true;
+    }
+
+    case Expr::Or: {
+        QVector<int> left, right;
+        if (!indexCandidates(index, expr->left, left) || !indexCandidates(index, expr->right, right)) return false;
+        result = uniteLists(left, right);
+        return true;
+    }
+    }
+
+    return false;
+}
+
+
+bool TDriverObjectQuery::matches(const TDriverObjectIndex &index, int ordinal, const ExprPtr &expr)
+{
+    QString value;
+
+    switch (expr->kind) {
+    case Expr::And:
+        return matches(index, ordinal, expr->left) && matches(index, ordinal, expr->right);
+    case Expr::Or:
+        return matches(index, ordinal, expr->left) || matches(index, ordinal, expr->right);
+    case Expr::Exists:
+        return objectValue(index, ordinal, expr->name, value);
+    case Expr::Equals:
+        return objectValue(index, ordinal, expr->name, value) && value == expr->value;
+    case Expr::NotEquals:
+        return objectValue(index, ordinal, expr->name, value) && value != expr->value;
+    case Expr::Contains:
+        return objectValue(index, ordinal, expr->name, value) && value.contains(expr->value, Qt::CaseInsensitive);
+    }
+
+    return false;
+}
+
+
+bool TDriverObjectQuery::matchesAll(const TDriverObjectIndex &index, int ordinal, const QList<ExprPtr> &predicates)
+{
+    foreach (const ExprPtr &predicate, predicates) {
+        if (!matches(index, ordinal, predicate)) return false;
+    }
+    return true;
+}
+
+
+QVector<int> TDriverObjectQuery::evaluate(const TDriverObjectIndex &index) const
+{
+    QVector<int> context;
+    bool atRoot = true;
+
+    foreach (const Step &step, steps) {
+
+        // narrow down candidates using type and predicate indexes
+        QVector<int> candidates;
+        bool indexed = false;
+
+        if (!step.type.isEmpty()) {
+            candidates = index.objectsOfType(step.type);
+            indexed = true;
+        }
+
+        foreach (const ExprPtr &predicate, step.predicates) {
+            QVector<int> list;
+            if (indexCandidates(index, predicate, list)) {
+                candidates = indexed ? intersectLists(candidates, list) : list;
+                indexed = true;
+            }
+        }
+
+        if (!indexed) {
+            candidates.resize(index.count());
+            for (int ii = 0; ii < candidates.size(); ++ii) candidates[ii] = ii;
+        }
+
+        // filter candidates by relation to context, and verify predicates
+        QVector<int> result;
+
+        if (atRoot) {
+            foreach (int ordinal, candidates) {
+                if ((step.descendant || index.parent(ordinal) < 0)
+                        && matchesAll(index, ordinal, step.predicates)) {
+                    result << ordinal;
+                }
+            }
+        }
+        else if (step.descendant) {
+            // merge subtree ranges of context objects, both lists are sorted
+            QVector<QPair<int, int> > ranges;
+            foreach (int ordinal, context) {
+                const int begin = ordinal + 1;
+                const int end = index.subtreeEnd(ordinal);
+                if (!ranges.isEmpty() && begin < ranges.last().second) {
+                    if (end > ranges.last().second) ranges.last().second = end;
+                }
+                else if (begin < end) {
+                    ranges << qMakePair(begin, end);
+                }
+            }
+
+            int range = 0;
+            foreach (int ordinal, candidates) {
+                while (range < ranges.size() && ranges.at(range).second <= ordinal) ++range;
+                if (range >= ranges.size()) break;
+                if (ordinal >= ranges.at(range).first && matchesAll(index, ordinal, step.predicates)) {
+                    result << ordinal;
+                }
+            }
+        }
+        else {
+            QBitArray inContext(index.count());
+            foreach (int ordinal, context) inContext.setBit(ordinal);
+
+            foreach (int ordinal, candidates) {
+                const int parent = index.parent(ordinal);
+                if (parent >= 0 && inContext.testBit(parent) && matchesAll(index, ordinal, step.predicates)) {
+                    result << ordinal;
+                }
+            }
+        }
+
+        context = result;
+        atRoot = false;
+        if (context.isEmpty()) break;
+    }
+
+    return context;
+}
@@ -0,0 +1,97 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+#ifndef TDRIVER_OBJECTQUERY_H
+#define TDRIVER_OBJECTQUERY_H
+
+#include <QCoreApplication>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+class TDriverObjectIndex;
+
+// XPath-like query over TDriverObjectIndex, for example
+//   //QPushButton[@visible='true' and @text~='OK']
+//   /sut/*/QWidget[(@enabled='true' or @focus) and @objectName!='']
+// Steps are "/" (child) or "//" (descendant) followed by object type or "*".
+// Predicates compare attributes: = (exact), != (exact), ~= (substring, any case),
+// or just @name to test that attribute exists. Attributes name, type and id fall
+// back to object tree data, if object has no such attribute.
+class TDriverObjectQuery
+{
+    Q_DECLARE_TR_FUNCTIONS(TDriverObjectQuery)
+
+public:
+    TDriverObjectQuery();
+
+    // returns false and sets errorString() if query is not valid
+    bool parse(const QString &query);
+    bool isValid() const { return !steps.isEmpty(); }
+    QString errorString() const { return error; }
+
+    // sorted ordinals of matching objects
+    QVector<int> evaluate(const TDriverObjectIndex &index) const;
+
+    // quotes value for query, returns null string if value can't be quoted
+    static QString quoted(const QString &value);
+
+private:
+    struct Expr {
+        enum Kind { And, Or, Exists, Equals, NotEquals, Contains };
+        Kind kind;
+        QString name; // lower case attribute name
+        QString value;
+        QSharedPointer<Expr> left;
+        QSharedPointer<Expr> right;
+    };
+    typedef QSharedPointer<Expr> ExprPtr;
+
+    struct Step {
+        bool descendant;
+        QString type; // empty for any type
+        QList<ExprPtr> predicates;
+    };
+
+    // parser
+    bool parseStep();
+    ExprPtr parseOr();
+    ExprPtr parseAnd();
+    ExprPtr parsePrimary();
+    QString parseName();
+    void skipSpace();
+    bool accept(const QString &token);
+    bool acceptKeyword(const QString &keyword);
+    bool fail(const QString &message);
+
+    // evaluation
+    static bool indexCandidates(const TDriverObjectIndex &index, const ExprPtr &expr, QVector<int> &result);
+    static bool matches(const TDriverObjectIndex &index, int ordinal, const ExprPtr &expr);
+    static bool matchesAll(const TDriverObjectIndex &index, int ordinal, const QList<ExprPtr> &predicates);
+
+    QList<Step> steps;
+    QString error;
+
+    QString text;
+    int pos;
+};
+
+#endif // TDRIVER_OBJECTQUERY_H
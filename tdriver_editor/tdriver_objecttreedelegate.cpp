@@ -0,0 +1,91 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+
+#include "tdriver_objecttreedelegate.h"
+
+#include <QBrush>
+#include <QColor>
+#include <QPalette>
+
+namespace {
+
+struct ObjectTreeStyles {
+    ObjectTreeStyles() :
+        warningBackground(QColor(Qt::red)),
+        warningText(Qt::white)
+    {
+        columnText[0] = QColor(Qt::darkCyan).darker(180);
+        columnText[1] = QColor(Qt::darkGreen);
+        columnText[2] = QColor(Qt::darkYellow);
+    }
+
+    QBrush warningBackground;
+    QColor warningText;
+    QColor columnText[3];
+};
+
+const ObjectTreeStyles &styles()
+{
+    static const ObjectTreeStyles instance;
+    return instance;
+}
+
+}
+
+
+TDriverObjectTreeDelegate::TDriverObjectTreeDelegate(QObject *parent) :
+    QStyledItemDelegate(parent)
+{
+}
+
+
+int TDriverObjectTreeDelegate::itemFlags(const QModelIndex &index)
+{
+    return index.sibling(index.row(), 0).data(FlagsRole).toInt();
+}
+
+
+bool TDriverObjectTreeDelegate::isWarning(int flags, int column)
+{
+    switch (column) {
+    case 0: return (flags & MissingType) != 0;
+    case 1: return (flags & (MissingName | DuplicateName | DuplicateNameAndId)) != 0;
+    default: return false;
+    }
+}
+
+
+void TDriverObjectTreeDelegate::initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const
+{
+    QStyledItemDelegate::initStyleOption(option, index);
+
+    const ObjectTreeStyles &s = styles();
+    int column = index.column();
+
+    if (isWarning(itemFlags(index), column)) {
+        option->backgroundBrush = s.warningBackground;
+        option->palette.setColor(QPalette::Text, s.warningText);
+    }
+    else if (column >= 0 && column < 3) {
+        option->palette.setColor(QPalette::Text, s.columnText[column]);
+    }
+}
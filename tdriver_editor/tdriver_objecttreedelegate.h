@@ -0,0 +1,54 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+
+
+
+#ifndef TDRIVER_OBJECTTREEDELEGATE_H
+#define TDRIVER_OBJECTTREEDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+// Paints object tree cells from a few shared brushes selected by per-item
+// state flags, so tree items only carry display texts and one flags value
+// instead of per-cell fonts, colors and tooltip strings.
+class TDriverObjectTreeDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    // flags are stored in column 0 of each item
+    enum { FlagsRole = Qt::UserRole + 1 };
+
+    enum ItemFlag {
+        MissingType = 0x1,
+        MissingName = 0x2,
+        DuplicateName = 0x4,
+        DuplicateNameAndId = 0x8
+    };
+
+    explicit TDriverObjectTreeDelegate(QObject *parent = 0);
+
+    static int itemFlags(const QModelIndex &index);
+    static bool isWarning(int flags, int column);
+
+protected:
+    void initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const;
+};
+
+#endif // TDRIVER_OBJECTTREEDELEGATE_H
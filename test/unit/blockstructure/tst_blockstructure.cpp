@@ -0,0 +1,219 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+#include "tdriver_blockstructure.h"
+
+#include <QtTest>
+#include <QTextDocument>
+#include <QTextCursor>
+#include <QTextCharFormat>
+#include <QSyntaxHighlighter>
+
+
+class TestBlockStructure : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void keywordOpeners_data();
+    void keywordOpeners();
+    void modifiersInsideBlock();
+    void incrementalEdit_data();
+    void incrementalEdit();
+    void formatOnlyChange();
+};
+
+
+static const char *const rubySource =
+        "def foo(x)\n"
+        "  if x\n"
+        "    bar(1,\n"
+        "        2)\n"
+        "  end\n"
+        "end\n"
+        "=begin\n"
+        "def not_code\n"
+        "=end\n"
+        "s = \"abc\n"
+        "def in_string\n"
+        "\"\n"
+        "baz\n";
+
+
+// structure updated from contentsChange must equal one built from scratch
+static void compareWithRebuilt(QTextDocument &doc, TDriverBlockStructure &structure)
+{
+    QTextDocument freshDoc(doc.toPlainText());
+    TDriverBlockStructure rebuilt(&freshDoc);
+    rebuilt.setRubyMode(true);
+
+    QCOMPARE(doc.blockCount(), freshDoc.blockCount());
+    for (int ii = 0; ii < doc.blockCount(); ++ii) {
+        QVERIFY2(structure.blockDepth(ii) == rebuilt.blockDepth(ii),
+                 qPrintable(QString("blockDepth differs on block %1").arg(ii)));
+        QVERIFY2(structure.blockOpenCount(ii) == rebuilt.blockOpenCount(ii),
+                 qPrintable(QString("blockOpenCount differs on block %1").arg(ii)));
+        QVERIFY2(structure.foldEnd(ii) == rebuilt.foldEnd(ii),
+                 qPrintable(QString("foldEnd differs on block %1").arg(ii)));
+    }
+}
+
+
+// sets a format on every character, which changes document contents without changing text
+class FormattingHighlighter : public QSyntaxHighlighter
+{
+public:
+    FormattingHighlighter(QTextDocument *doc) : QSyntaxHighlighter(doc) {}
+
+protected:
+    void highlightBlock(const QString &text)
+    {
+        QTextCharFormat format;
+        format.setFontWeight(QFont::Bold);
+        setFormat(0, text.length(), format);
+    }
+};
+
+
+void TestBlockStructure::keywordOpeners_data()
+{
+    QTest::addColumn<QString>("line");
+    QTest::addColumn<int>("openCount");
+
+    QTest::newRow("if statement") << "if x" << 1;
+    QTest::newRow("unless statement") << "unless x" << 1;
+    QTest::newRow("while statement") << "while x do" << 1;
+    QTest::newRow("until statement") << "until x" << 1;
+    QTest::newRow("assigned if") << "y = if x" << 1;
+    QTest::newRow("if after semicolon") << "foo; if x" << 1;
+
+    QTest::newRow("return if") << "return if x" << 0;
+    QTest::newRow("return unless") << "return unless x" << 0;
+    QTest::newRow("call unless") << "foo unless bar" << 0;
+    QTest::newRow("call if") << "foo(1) if bar" << 0;
+    QTest::newRow("assignment if") << "y = 1 if x" << 0;
+    QTest::newRow("method call while") << "obj.step while obj.busy?" << 0;
+    QTest::newRow("break until") << "break until x" << 0;
+    QTest::newRow("raise unless") << "raise 'error' unless ok" << 0;
+}
+
+
+void TestBlockStructure::keywordOpeners()
+{
+    QFETCH(QString, line);
+    QFETCH(int, openCount);
+
+    QTextDocument doc(line);
+    TDriverBlockStructure structure(&doc);
+    structure.setRubyMode(true);
+
+    QCOMPARE(structure.blockOpenCount(0), openCount);
+}
+
+
+// modifier lines must not shift nesting of the enclosing method
+void TestBlockStructure::modifiersInsideBlock()
+{
+    QTextDocument doc("def foo(x)\n"
+                      "  return if x.nil?\n"
+                      "  bar unless x.empty?\n"
+                      "  x += 1 while x < 10\n"
+                      "end\n"
+                      "baz\n");
+    TDriverBlockStructure structure(&doc);
+    structure.setRubyMode(true);
+
+    QCOMPARE(structure.blockDepth(1), 1);
+    QCOMPARE(structure.blockDepth(4), 1);
+    QCOMPARE(structure.blockDepth(5), 0);
+    QCOMPARE(structure.foldEnd(0), 4);
+}
+
+
+void TestBlockStructure::incrementalEdit_data()
+{
+    // edit is done at first occurrence of marker
+    QTest::addColumn<QString>("marker");
+    QTest::addColumn<int>("removed");
+    QTest::addColumn<QString>("inserted");
+
+    QTest::newRow("insert lines") << "  if x" << 0 << "  while y do\n    z\n  end\n";
+    QTest::newRow("insert unclosed opener") << "baz" << 0 << "if q\n";
+    QTest::newRow("delete line") << "  end\n" << 6 << "";
+    QTest::newRow("delete lines") << "    bar(1,\n" << 22 << "";
+    QTest::newRow("replace lines") << "  if x\n" << 29 << "  [\n  ]\n";
+    QTest::newRow("edit inside begin/end") << "def not_code" << 0 << "x = [\n";
+    QTest::newRow("remove end of begin/end") << "=end\n" << 5 << "";
+    QTest::newRow("insert begin") << "def foo" << 0 << "=begin\n";
+    QTest::newRow("close string") << "\ndef in_string" << 0 << "\"";
+    QTest::newRow("remove string quote") << "\"abc" << 1 << "";
+    QTest::newRow("open string") << "baz" << 0 << "'";
+    QTest::newRow("join lines") << "\nend\n=begin" << 1 << "";
+}
+
+
+void TestBlockStructure::incrementalEdit()
+{
+    QFETCH(QString, marker);
+    QFETCH(int, removed);
+    QFETCH(QString, inserted);
+
+    QTextDocument doc(rubySource);
+    TDriverBlockStructure structure(&doc);
+    structure.setRubyMode(true);
+
+    // query every block first, so cached depths are in use when the edit comes
+    compareWithRebuilt(doc, structure);
+
+    int position = doc.toPlainText().indexOf(marker);
+    QVERIFY(position >= 0);
+
+    QTextCursor cursor(&doc);
+    cursor.setPosition(position);
+    cursor.setPosition(position + removed, QTextCursor::KeepAnchor);
+    cursor.insertText(inserted);
+
+    compareWithRebuilt(doc, structure);
+}
+
+
+// contentsChange with equal removed and added counts must not disturb the structure
+void TestBlockStructure::formatOnlyChange()
+{
+    QTextDocument doc(rubySource);
+    TDriverBlockStructure structure(&doc);
+    structure.setRubyMode(true);
+    compareWithRebuilt(doc, structure);
+
+    FormattingHighlighter *highlighter = new FormattingHighlighter(&doc);
+    highlighter->rehighlight();
+    compareWithRebuilt(doc, structure);
+
+    QTextCursor cursor(&doc);
+    cursor.movePosition(QTextCursor::Down, QTextCursor::MoveAnchor, 2);
+    cursor.movePosition(QTextCursor::Down, QTextCursor::KeepAnchor, 6);
+    QTextCharFormat format;
+    format.setFontItalic(true);
+    cursor.mergeCharFormat(format);
+    compareWithRebuilt(doc, structure);
+}
+
+
+QTEST_MAIN(TestBlockStructure)
+#include "tst_blockstructure.moc"
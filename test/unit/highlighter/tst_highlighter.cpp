@@ -0,0 +1,74 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+#include "tdriver_highlighter.h"
+
+#include <QtTest>
+#include <QTextDocument>
+#include <QTextCursor>
+#include <QTextBlock>
+
+
+// userState of blocks not yet reached by incremental highlighting
+static const int deferredState = -2;
+
+class TestHighlighter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void deleteAbovePendingBlock();
+};
+
+
+// lines deleted above the incremental pass position must not leave deferred blocks behind
+void TestHighlighter::deleteAbovePendingBlock()
+{
+    QString text;
+    for (int ii = 0; ii < 100000; ++ii) text += QString("x%1 = 'a' # b\n").arg(ii);
+    QTextDocument doc(text);
+    TDriverHighlighter *highlighter = new TDriverHighlighter(&doc);
+
+    highlighter->highlightIncrementally(&doc, 0, 10);
+    QCoreApplication::processEvents();
+
+    int first = -1;
+    for (QTextBlock block = doc.begin(); block.isValid(); block = block.next()) {
+        if (block.userState() == deferredState) {
+            first = block.blockNumber();
+            break;
+        }
+    }
+    if (first < 0) QSKIP("incremental pass finished before the edit");
+
+    QTextCursor cursor(&doc);
+    cursor.setPosition(doc.findBlockByNumber(first).position(), QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+
+    QTRY_VERIFY_WITH_TIMEOUT(!highlighter->isIncrementalPending(), 60000);
+
+    for (QTextBlock block = doc.begin(); block.isValid(); block = block.next()) {
+        QVERIFY2(block.userState() != deferredState,
+                 qPrintable(QString("block %1 left deferred").arg(block.blockNumber())));
+    }
+}
+
+
+QTEST_MAIN(TestHighlighter)
+#include "tst_highlighter.moc"
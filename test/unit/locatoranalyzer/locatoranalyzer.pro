@@ -0,0 +1,37 @@
+############################################################################
+##
+## Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+## All rights reserved.
+## Contact: Nokia Corporation (testabilitydriver@nokia.com)
+##
+## This file is part of Testability Driver.
+##
+## If you have questions regarding the use of this file, please contact
+## Nokia at testabilitydriver@nokia.com .
+##
+## This library is free software; you can redistribute it and/or
+## modify it under the terms of the GNU Lesser General Public
+## License version 2.1 as published by the Free Software Foundation
+## and appearing in the file LICENSE.LGPL included in the packaging
+## of this file.
+##
+############################################################################
+
+TEMPLATE = app
+TARGET = tst_locatoranalyzer
+CONFIG += testcase
+QT += testlib widgets concurrent
+
+# analyzer sources are part of the application, so they are compiled in directly
+DEPENDPATH += ../../../tdriver_editor ../../../inc
+INCLUDEPATH += ../../../tdriver_editor ../../../inc
+
+INCLUDEPATH += ../../../libtdriverutil
+QMAKE_LIBDIR += ../../../bin
+LIBS += -ltdriverutil
+
+HEADERS += ../../../tdriver_editor/tdriver_objectindex.h \
+    ../../../tdriver_editor/tdriver_locatoranalyzer.h
+SOURCES += tst_locatoranalyzer.cpp \
+    ../../../tdriver_editor/tdriver_objectindex.cpp \
+    ../../../tdriver_editor/tdriver_locatoranalyzer.cpp
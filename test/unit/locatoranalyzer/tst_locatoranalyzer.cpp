@@ -0,0 +1,167 @@
+/***************************************************************************
+**
+** Copyright (C) 2010 Nokia Corporation and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (testabilitydriver@nokia.com)
+**
+** This file is part of Testability Driver.
+**
+** If you have questions regarding the use of this file, please contact
+** Nokia at testabilitydriver@nokia.com .
+**
+** This library is free software; you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation
+** and appearing in the file LICENSE.LGPL included in the packaging
+** of this file.
+**
+****************************************************************************/
+
+#include "tdriver_objectindex.h"
+#include "tdriver_locatoranalyzer.h"
+
+#include <QtTest>
+#include <QTreeWidgetItem>
+
+
+class TestLocatorAnalyzer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void sharedTextNamedAndUnnamed();
+    void emptyNameSharedWithTextObject();
+    void uniqueText();
+    void indexInsideApplication();
+
+private:
+    QTreeWidgetItem *addObject(QTreeWidgetItem *parent, const QString &type,
+                               const QString &name, const QString &text = QString());
+    QSharedPointer<const TDriverObjectIndex> buildIndex();
+    int ordinalOf(const QTreeWidgetItem *item) const;
+
+    QTreeWidgetItem *root;
+    QTreeWidgetItem *sut;
+    TestObjectKey nextKey;
+    TestObjectArray<TreeItemInfo> treeData;
+    TestObjectArray<QMap<QString, AttributeInfo> > attributes;
+    QSharedPointer<const TDriverObjectIndex> index;
+};
+
+
+void TestLocatorAnalyzer::init()
+{
+    nextKey = 1;
+    root = new QTreeWidgetItem;
+    sut = addObject(root, "sut", "sut");
+}
+
+
+void TestLocatorAnalyzer::cleanup()
+{
+    delete root;
+    root = sut = NULL;
+    treeData.clear();
+    attributes.clear();
+    index.clear();
+}
+
+
+QTreeWidgetItem *TestLocatorAnalyzer::addObject(QTreeWidgetItem *parent, const QString &type,
+                                                const QString &name, const QString &text)
+{
+    const TestObjectKey key = nextKey++;
+    QTreeWidgetItem *item = new QTreeWidgetItem(parent);
+    item->setData(0, TestObjectKeyRole, key);
+
+    TreeItemInfo info;
+    info.type = type;
+    info.name = name;
+    info.id = QString::number(key);
+    treeData.insert(key, info);
+
+    if (!text.isEmpty()) {
+        AttributeInfo attr;
+        attr.name = "text";
+        attr.value = text;
+        attributes[key].insert("text", attr);
+    }
+    return item;
+}
+
+
+QSharedPointer<const TDriverObjectIndex> TestLocatorAnalyzer::buildIndex()
+{
+    TDriverObjectIndex *newIndex = new TDriverObjectIndex;
+    newIndex->build(root, treeData, attributes);
+    index = QSharedPointer<const TDriverObjectIndex>(newIndex);
+    return index;
+}
+
+
+int TestLocatorAnalyzer::ordinalOf(const QTreeWidgetItem *item) const
+{
+    return index->ordinal(ptr2TestObjectKey(item));
+}
+
+
+// unnamed object must not get Type( :text ) locator, when a named object has same type and text
+void TestLocatorAnalyzer::sharedTextNamedAndUnnamed()
+{
+    QTreeWidgetItem *named = addObject(sut, "QPushButton", "okButton", "OK");
+    QTreeWidgetItem *unnamed = addObject(sut, "QPushButton", "NoName", "OK");
+    TDriverLocatorAnalyzer analyzer(buildIndex());
+
+    QCOMPARE(analyzer.locator(ordinalOf(named)),
+             QString("QPushButton( :name => 'okButton' )"));
+    QCOMPARE(analyzer.locator(ordinalOf(unnamed)),
+             QString("QPushButton( :name => '', :text => 'OK' )"));
+    QVERIFY(!analyzer.locatorNeedsIndex(ordinalOf(unnamed)));
+}
+
+
+// Type( :name => '' ) also matches unnamed objects which have text
+void TestLocatorAnalyzer::emptyNameSharedWithTextObject()
+{
+    QTreeWidgetItem *plain = addObject(sut, "QLabel", "NoName");
+    addObject(sut, "QLabel", "NoName", "Title");
+    TDriverLocatorAnalyzer analyzer(buildIndex());
+
+    QVERIFY(analyzer.locatorNeedsIndex(ordinalOf(plain)));
+    QCOMPARE(analyzer.locator(ordinalOf(plain)),
+             QString("QLabel( :name => '', :__index => 0 )"));
+}
+
+
+void TestLocatorAnalyzer::uniqueText()
+{
+    QTreeWidgetItem *cancel = addObject(sut, "QPushButton", "NoName", "Cancel");
+    addObject(sut, "QPushButton", "okButton", "OK");
+    TDriverLocatorAnalyzer analyzer(buildIndex());
+
+    QCOMPARE(analyzer.locator(ordinalOf(cancel)),
+             QString("QPushButton( :text => 'Cancel' )"));
+}
+
+
+// :__index counts only objects of the application the locator is used in
+void TestLocatorAnalyzer::indexInsideApplication()
+{
+    QTreeWidgetItem *firstApp = addObject(sut, "application", "first");
+    QTreeWidgetItem *secondApp = addObject(sut, "application", "second");
+    addObject(addObject(firstApp, "QWidget", "NoName"), "QLabel", "NoName");
+    QTreeWidgetItem *view = addObject(secondApp, "QWidget", "NoName");
+    addObject(view, "QLabel", "NoName");
+    QTreeWidgetItem *second = addObject(view, "QLabel", "NoName");
+    TDriverLocatorAnalyzer analyzer(buildIndex());
+
+    QCOMPARE(analyzer.locator(ordinalOf(second)),
+             QString("QLabel( :name => '', :__index => 1 )"));
+}
+
+
+QTEST_MAIN(TestLocatorAnalyzer)
+#include "tst_locatoranalyzer.moc"